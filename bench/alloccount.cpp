@@ -0,0 +1,110 @@
+/*
+ * alloccount.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "alloccount.hpp"
+#include <atomic>
+#include <cerrno>
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+// the sanitizers replace malloc() themselves
+
+AllocStats allocStats()
+{
+  AllocStats stats = { 0, 0 };
+  return stats;
+}
+
+bool allocCountingEnabled()
+{
+  return false;
+}
+
+#else
+
+extern "C"
+{
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+}
+
+static std::atomic<size_t> allocCount(0);
+static std::atomic<size_t> allocBytes(0);
+
+static inline void count(size_t size)
+{
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+extern "C"
+{
+void *malloc(size_t size)
+{
+  count(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t number, size_t size)
+{
+  count(number * size);
+  return __libc_calloc(number, size);
+}
+
+void *realloc(void *pointer, size_t size)
+{
+  count(size);
+  return __libc_realloc(pointer, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+  count(size);
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+  count(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size)
+{
+  count(size);
+  void *result = __libc_memalign(alignment, size);
+  if (result == NULL)
+  {
+    return ENOMEM;
+  }
+
+  *pointer = result;
+  return 0;
+}
+
+void free(void *pointer)
+{
+  __libc_free(pointer);
+}
+}
+
+AllocStats allocStats()
+{
+  AllocStats stats;
+  stats.count = allocCount.load(std::memory_order_relaxed);
+  stats.bytes = allocBytes.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool allocCountingEnabled()
+{
+  return true;
+}
+
+#endif
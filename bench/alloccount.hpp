@@ -0,0 +1,29 @@
+/*
+ * alloccount.hpp
+ *
+ * counts heap allocations by replacing malloc() and friends (glibc only).
+ * Every allocation of the process is counted, including those of operator
+ * new and of the parser library.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef ALLOCCOUNT_H_
+#define ALLOCCOUNT_H_
+
+#include <cstddef>
+
+struct AllocStats
+{
+  size_t count; // number of malloc(), calloc(), realloc() etc. calls
+  size_t bytes; // total number of requested bytes
+};
+
+// totals since program start
+AllocStats allocStats();
+
+// false if the allocations can't be counted, e.g. in sanitizer builds
+bool allocCountingEnabled();
+
+#endif /* ALLOCCOUNT_H_ */
@@ -0,0 +1,212 @@
+/*
+ * asynccallbacks.cpp
+ *
+ * checks async callbacks: callbacks of the same key run in order, keys
+ * ordered by registerCallbackOrder() wait for each other, contradicting
+ * orders are rejected, and waitForCallbacks(), callbacksDone(), reset() and
+ * the destructor see every callback finish. Exits with 1 otherwise, a
+ * deadlock is killed after a minute. Run by 'make check', configure with
+ * --enable-tsan to check for races as well.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+static void parse(ArgumentParser &args, const char *commandString)
+{
+  args.parseCommandString(commandString, strlen(commandString));
+}
+
+static void sleepMs(int milliseconds)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+static std::mutex sequenceMutex;
+static std::vector<int> sequence;
+
+// later values are faster, so they'd overtake if they weren't ordered
+static void checkSameKey()
+{
+  ArgumentParser args("asynccallbacks");
+  args.Int("seq", 0, "sequence number");
+  args.registerCallback("seq", [](const ArgumentParser::Event &event)
+  {
+    std::this_thread::sleep_for(
+      std::chrono::microseconds((40 - event.value.intValue) * 100));
+    std::lock_guard<std::mutex> lock(sequenceMutex);
+    sequence.push_back(event.value.intValue);
+  });
+  args.setAsyncCallbacks(4);
+
+  std::string command;
+  for (int i = 0; i < 40; ++i)
+  {
+    command += "--seq=" + std::to_string(i) + " ";
+  }
+  parse(args, command.c_str());
+
+  check(args.callbacksDone(), "waitAtEnd returned before the callbacks");
+  std::lock_guard<std::mutex> lock(sequenceMutex);
+  bool ordered = sequence.size() == 40;
+  for (size_t i = 0; ordered && i < sequence.size(); ++i)
+  {
+    ordered = sequence[i] == int(i);
+  }
+  check(ordered, "callbacks of the same key ran out of order");
+}
+
+static std::atomic<bool> firstDone(false);
+static std::atomic<bool> secondDone(false);
+static std::atomic<int> orderErrors(0);
+static std::atomic<int> freeRuns(0);
+
+// first < second < third, all of them slow enough to be overtaken
+static void checkOrder()
+{
+  ArgumentParser args("asynccallbacks");
+  args.Int("first", 0, "runs first");
+  args.Int("second", 0, "runs after first");
+  args.Int("third", 0, "runs after second");
+  args.Int("free", 0, "not ordered");
+  args.registerCallback("first", [](const ArgumentParser::Event&)
+  {
+    sleepMs(20);
+    firstDone.store(true);
+  });
+  args.registerCallback("second", [](const ArgumentParser::Event&)
+  {
+    if (!firstDone.load())
+    {
+      ++orderErrors;
+    }
+    sleepMs(10);
+    secondDone.store(true);
+  });
+  args.registerCallback("third", [](const ArgumentParser::Event&)
+  {
+    if (!secondDone.load())
+    {
+      ++orderErrors;
+    }
+  });
+  args.registerCallback("free", [](const ArgumentParser::Event&)
+  {
+    ++freeRuns;
+  });
+
+  args.registerCallbackOrder("first", "second");
+  args.registerCallbackOrder("second", "third");
+  // both would close a cycle, which would deadlock if it was accepted
+  fprintf(stderr, "expected: two rejected orders\n");
+  args.registerCallbackOrder("third", "first");
+  args.registerCallbackOrder("second", "first");
+
+  args.setAsyncCallbacks(4);
+  for (int i = 0; i < 5; ++i)
+  {
+    firstDone.store(false);
+    secondDone.store(false);
+    parse(args, "--third=1 --free=1 --second=1 --first=1");
+    args.reset();
+  }
+
+  check(orderErrors.load() == 0, "a callback ran before the ones before it");
+  check(freeRuns.load() == 5, "an unordered callback didn't run");
+}
+
+static std::atomic<bool> gateOpen(false);
+static std::atomic<int> gatedRuns(0);
+
+// blocks the callback until the gate opens
+static void registerGated(ArgumentParser &args)
+{
+  args.Int("slow", 0, "waits for the gate");
+  args.registerCallback("slow", [](const ArgumentParser::Event&)
+  {
+    while (!gateOpen.load())
+    {
+      sleepMs(1);
+    }
+    ++gatedRuns;
+  });
+}
+
+static void openGateLater()
+{
+  sleepMs(50);
+  gateOpen.store(true);
+}
+
+static void checkCompletion()
+{
+  // waitForCallbacks() and callbacksDone() are the completion handle
+  {
+    ArgumentParser args("asynccallbacks");
+    registerGated(args);
+    args.setAsyncCallbacks(2, false);
+
+    gateOpen.store(false);
+    gatedRuns.store(0);
+    parse(args, "--slow=1");
+    check(!args.callbacksDone(), "callbacksDone() before the callback ran");
+    check(gatedRuns.load() == 0, "the parse waited for its callbacks");
+
+    gateOpen.store(true);
+    args.waitForCallbacks();
+    check(args.callbacksDone() && gatedRuns.load() == 1,
+      "waitForCallbacks() returned before the callback finished");
+  }
+
+  // reset() waits
+  {
+    ArgumentParser args("asynccallbacks");
+    registerGated(args);
+    args.setAsyncCallbacks(2, false);
+
+    gateOpen.store(false);
+    gatedRuns.store(0);
+    parse(args, "--slow=1");
+    std::thread opener(openGateLater);
+    args.reset();
+    check(gatedRuns.load() == 1, "reset() didn't wait for the callback");
+    opener.join();
+  }
+
+  // the destructor waits
+  gateOpen.store(false);
+  gatedRuns.store(0);
+  std::thread opener(openGateLater);
+  {
+    ArgumentParser args("asynccallbacks");
+    registerGated(args);
+    args.setAsyncCallbacks(2, false);
+    parse(args, "--slow=1");
+  }
+  check(gatedRuns.load() == 1, "the destructor didn't wait for the callback");
+  opener.join();
+}
+
+int main()
+{
+  // a deadlock fails the check instead of hanging it
+  alarm(60);
+
+  checkSameKey();
+  checkOrder();
+  checkCompletion();
+
+  return checkResult();
+}
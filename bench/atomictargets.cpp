@@ -0,0 +1,123 @@
+/*
+ * atomictargets.cpp
+ *
+ * checks std::atomic targets: parses, sets and cleared layers store the new
+ * value in the atomic, an atomic of another type than its option is
+ * rejected, and a thread can poll an atomic while the parser writes it.
+ * Exits with 1 otherwise. Run by 'make check', configure with --enable-tsan
+ * to check for races as well.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+static void parse(ArgumentParser &args, const char *commandString)
+{
+  args.parseCommandString(commandString, strlen(commandString));
+}
+
+static void checkWrites()
+{
+  std::atomic<bool> verbose(false);
+  std::atomic<int> offset(0);
+  std::atomic<unsigned int> rate(100);
+  std::atomic<double> ratio(0.5);
+
+  ArgumentParser args("atomictargets");
+  args.Bool("verbose", false, "more output");
+  args.Int("offset", 0, "a signed number");
+  args.UInt("rate", 100u, "sampling rate");
+  args.Double("ratio", 0.5, "some ratio");
+  args.registerTarget("verbose", &verbose);
+  args.registerTarget("offset", &offset, std::memory_order_relaxed);
+  args.registerTarget("rate", &rate, std::memory_order_seq_cst);
+  // acquire isn't an order for stores, it falls back to release
+  args.registerTarget("ratio", &ratio, std::memory_order_acquire);
+
+  parse(args, "--verbose --offset=-3 --rate=7 --ratio=0.25");
+  check(verbose.load() && offset.load() == -3 && rate.load() == 7
+    && ratio.load() == 0.25, "a parse didn't write an atomic");
+
+  args.set("rate", 8u);
+  args.parseLine("offset = 4");
+  check(rate.load() == 8 && offset.load() == -3,
+    "a set didn't write an atomic, or a lower layer overrode it");
+
+  // the cleared values fall back to the user layer or the default
+  args.clearLayer(ArgumentParser::argvLayer);
+  check(!verbose.load() && offset.load() == 4 && rate.load() == 8
+    && ratio.load() == 0.5, "a cleared layer didn't write an atomic");
+}
+
+static void checkWrongType()
+{
+  std::atomic<int> wrong(11);
+  std::atomic<unsigned int> right(12);
+
+  ArgumentParser args("atomictargets");
+  args.UInt("rate", 100u, "sampling rate");
+  args.Double("ratio", 0.5, "some ratio");
+  fprintf(stderr, "expected: two atomic targets that don't match\n");
+  args.registerTarget("rate", &wrong);
+  args.registerTarget("ratio", &right);
+
+  parse(args, "--rate=7 --ratio=0.25");
+  check(wrong.load() == 11, "an atomic<int> was bound to a UInt option");
+  check(right.load() == 12,
+    "an atomic<unsigned int> was bound to a Double option");
+
+  // a matching atomic still works after the rejected ones
+  args.registerTarget("rate", &right);
+  args.set("rate", 9u);
+  check(right.load() == 9, "the matching atomic wasn't written");
+}
+
+// the reader only ever sees values the parser set
+static void checkPolling()
+{
+  std::atomic<int> level(1);
+  std::atomic<bool> done(false);
+  std::atomic<int> wrongValues(0);
+
+  ArgumentParser args("atomictargets");
+  args.Int("level", 1, "log level");
+  args.registerTarget("level", &level);
+
+  std::thread reader([&]()
+  {
+    while (!done.load())
+    {
+      int value = level.load(std::memory_order_acquire);
+      if (value < 1 || value > 3)
+      {
+        ++wrongValues;
+      }
+    }
+  });
+
+  for (int i = 0; i < 10000; ++i)
+  {
+    args.set("level", i % 3 + 1);
+  }
+  done.store(true);
+  reader.join();
+
+  check(wrongValues.load() == 0, "a reader saw a value that wasn't set");
+  check(level.load() == 9999 % 3 + 1, "the last value wasn't stored");
+}
+
+int main()
+{
+  checkWrites();
+  checkWrongType();
+  checkPolling();
+
+  return checkResult();
+}
@@ -0,0 +1,98 @@
+/*
+ * batchorder.cpp
+ *
+ * checks batch mode: a batch commit writes each target once and fires the
+ * callbacks of every key that was set once, in order of registration, then
+ * the standalone callback once. Exits with 1 otherwise. Run by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static int alphaTarget = 0;
+static int betaTarget = 0;
+static int gammaTarget = 0;
+static int finalAlpha = 1; // last value of alpha in the current batch
+static std::string committed;
+
+static void append(const char *entry, int value)
+{
+  char buffer[32];
+  sprintf(buffer, "%s=%d ", entry, value);
+  committed += buffer;
+}
+
+int main()
+{
+  ArgumentParser args("batchorder");
+  args.Int("alpha", 0, "registered first", '\0', &alphaTarget);
+  args.Int("beta", 0, "registered second", '\0', &betaTarget);
+  args.Int("gamma", 0, "registered third", '\0', &gammaTarget);
+  args.Standalones();
+
+  // a key's target is written before its callbacks fire, with the last value
+  // of the batch
+  args.registerCallback("alpha", [](const ArgumentParser::Event &event)
+  {
+    check(alphaTarget == finalAlpha, "target not written before callback");
+    append("alpha", event.value.intValue);
+  });
+  args.registerCallback("alpha", [](const ArgumentParser::Event &event)
+  {
+    append("alpha2", event.value.intValue);
+  });
+  args.registerCallback("beta", [](const ArgumentParser::Event &event)
+  {
+    append("beta", event.value.intValue);
+  });
+  args.registerCallback("gamma", [](const ArgumentParser::Event &event)
+  {
+    append("gamma", event.value.intValue);
+  });
+  args.registerCallback(NULL, [](const ArgumentParser::Event &event)
+  {
+    committed += "standalones=";
+    committed += event.value.stringValue;
+  });
+
+  // keys in reverse order of registration, gamma twice
+  char arg0[] = "batchorder", arg1[] = "--gamma=3", arg2[] = "--beta=2",
+    arg3[] = "first", arg4[] = "--alpha=1", arg5[] = "--gamma=4",
+    arg6[] = "second";
+  char *argv[] = { arg0, arg1, arg2, arg3, arg4, arg5, arg6 };
+
+  args.setBatchMode(true);
+  args.parseArgs(7, argv);
+  check(committed == "alpha=1 alpha2=1 beta=2 gamma=4 standalones=second",
+    "parse committed in the wrong order");
+  printf("parse: %s\n", committed.c_str());
+
+  // a manual batch doesn't touch the targets before its commit
+  args.setBatchMode(false);
+  committed.clear();
+  args.beginBatch();
+  finalAlpha = 10;
+  args.set("gamma", 5);
+  args.set("alpha", 10);
+  args.set("gamma", 40);
+  args.set("beta", 20);
+  args.beginBatch();
+  args.set("gamma", 6);
+  args.set("gamma", 40);
+  args.commitBatch();
+  check(committed.empty(), "nested commit fired callbacks");
+  check(alphaTarget == 1 && betaTarget == 2 && gammaTarget == 4,
+    "target written before the commit");
+  args.commitBatch();
+  check(committed == "alpha=10 alpha2=10 beta=20 gamma=40 ",
+    "manual batch committed in the wrong order");
+  printf("batch: %s\n", committed.c_str());
+
+  return checkResult();
+}
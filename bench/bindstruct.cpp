@@ -0,0 +1,146 @@
+/*
+ * bindstruct.cpp
+ *
+ * checks bindStruct() and writeStruct(): parsed values land in the fields,
+ * strings are truncated to the size of their char array, and a struct
+ * written by writeStruct() reads back into another struct unchanged. Exits
+ * with 1 otherwise. Run by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+struct Config
+{
+  bool verbose;
+  int offset;
+  unsigned int threads;
+  double ratio;
+  char name[8];
+  char output_file[32];
+};
+
+static const ArgumentParser::Field fields[] = {
+  ARGUMENTPARSER_FIELD(Config, verbose, "more output", 'v'),
+  ARGUMENTPARSER_FIELD(Config, offset, "a signed number"),
+  ARGUMENTPARSER_FIELD(Config, threads, "number of threads", 't'),
+  ARGUMENTPARSER_FIELD(Config, ratio, "some ratio"),
+  ARGUMENTPARSER_FIELD(Config, name, "a short name"),
+  ARGUMENTPARSER_NAMED_FIELD(Config, output_file, "output", "output name") };
+
+static void parse(ArgumentParser &args, const char *commandString)
+{
+  args.parseCommandString(commandString, strlen(commandString));
+}
+
+static bool same(const Config &a, const Config &b)
+{
+  return a.verbose == b.verbose && a.offset == b.offset
+    && a.threads == b.threads && a.ratio == b.ratio
+    && strcmp(a.name, b.name) == 0 && strcmp(a.output_file, b.output_file) == 0;
+}
+
+// the current values of the fields are the defaults
+static void checkDefaults()
+{
+  Config config = { false, -1, 4, 0.5, "none", "out.txt" };
+  ArgumentParser args("bindstruct");
+  args.bindStruct(config, fields);
+  check(!args.getBool("verbose") && args.getInt("offset") == -1
+    && args.getUInt("threads") == 4 && args.getDouble("ratio") == 0.5
+    && strcmp(args.getCString("name"), "none") == 0
+    && strcmp(args.getCString("output"), "out.txt") == 0,
+    "the fields aren't the defaults");
+
+  // the struct isn't touched before a parse
+  check(config.offset == -1 && strcmp(config.name, "none") == 0,
+    "bindStruct() changed a field");
+}
+
+// strings that don't fit their array are cut and stay terminated
+static void checkTruncation()
+{
+  Config config = { false, 0, 1, 0.0, "", "" };
+  ArgumentParser args("bindstruct");
+  args.bindStruct(config, fields);
+
+  memset(config.name, 'x', sizeof(config.name));
+  parse(args, "--name=1234567");
+  check(strcmp(config.name, "1234567") == 0,
+    "a string that fits its array was cut");
+
+  memset(config.name, 'x', sizeof(config.name));
+  parse(args, "--name=12345678");
+  check(config.name[sizeof(config.name) - 1] == '\0'
+    && strcmp(config.name, "1234567") == 0,
+    "a string one byte too long wasn't truncated");
+
+  parse(args, "--name=a-much-longer-name-than-eight-bytes");
+  check(strcmp(config.name, "a-much-") == 0,
+    "a long string wasn't truncated");
+  check(config.output_file[0] == '\0' && config.ratio == 0.0,
+    "truncating a string overwrote the next field");
+
+  // the parser keeps the full value, only the field is cut
+  check(strcmp(args.getCString("name"),
+    "a-much-longer-name-than-eight-bytes") == 0, "the value was truncated");
+}
+
+// writeStruct() and a parse of its file give the same struct
+static void checkRoundTrip()
+{
+  char file[] = "/tmp/bindstructXXXXXX";
+  int fd = mkstemp(file);
+  if (fd < 0)
+  {
+    check(false, "can't create the file");
+    return;
+  }
+  close(fd);
+
+  Config written = { false, 0, 1, 0.0, "", "" };
+  {
+    ArgumentParser args("bindstruct");
+    args.bindStruct(written, fields);
+    parse(args, "-v --offset=-42 -t 16 --ratio=0.1 --name=short "
+      "--output=/var/tmp/result.txt");
+    check(written.verbose && written.offset == -42 && written.threads == 16
+      && written.ratio == 0.1 && strcmp(written.name, "short") == 0
+      && strcmp(written.output_file, "/var/tmp/result.txt") == 0,
+      "a parsed value didn't land in its field");
+    // needs all 17 digits to read back unchanged
+    written.ratio = 0.1 + 0.2;
+    check(!args.writeStruct(file, &written), "writeStruct() failed");
+
+    Config unbound = written;
+    fprintf(stderr, "expected: the struct isn't bound\n");
+    check(args.writeStruct(file, &unbound),
+      "writeStruct() wrote a struct that isn't bound");
+  }
+
+  Config read = { false, 7, 2, 2.0, "other", "other.txt" };
+  {
+    ArgumentParser args("bindstruct");
+    args.bindStruct(read, fields);
+    args.parseFile(file);
+    check(same(read, written), "the struct changed on its way through a file");
+  }
+
+  unlink(file);
+}
+
+int main()
+{
+  checkDefaults();
+  checkTruncation();
+  checkRoundTrip();
+
+  return checkResult();
+}
@@ -0,0 +1,34 @@
+/*
+ * check.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <atomic>
+#include <cstdio>
+
+static std::atomic<int> failures(0);
+
+void check(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    fprintf(stderr, "failed: %s\n", what);
+    ++failures;
+  }
+}
+
+int checkFailures()
+{
+  return failures.load();
+}
+
+int checkResult()
+{
+  int count = failures.load();
+  printf("%d failures\n", count);
+
+  return count == 0 ? 0 : 1;
+}
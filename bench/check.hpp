@@ -0,0 +1,24 @@
+/*
+ * check.hpp
+ *
+ * failure counting for the checks that 'make check' runs. check() may be
+ * called from several threads.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+// prints what failed to stderr and counts it if condition is false
+void check(bool condition, const char *what);
+
+// number of failed checks so far
+int checkFailures();
+
+// prints the number of failures, returns the exit code for main(): 0 if all
+// checks passed, 1 otherwise
+int checkResult();
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,142 @@
+/*
+ * clone.cpp
+ *
+ * per-task variants of a base configuration with 10000 keys, each with a few
+ * overrides: clone() compared to a parser of the shared schema that sets all
+ * values of the base again. Prints time and heap bytes per variant, and
+ * fails if a variant has wrong values.
+ *
+ * usage: clone [variants]
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <malloc.h>
+#include <time.h>
+
+static const unsigned int keyCount = 10000;
+static const unsigned int overrides = 3;
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t heapBytes()
+{
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+static std::vector<std::string> keys;
+
+static void override(ArgumentParser &variant, size_t task)
+{
+  for (unsigned int i = 0; i < overrides; ++i)
+  {
+    variant.set(keys[(task * 7 + i * 1237) % keyCount].c_str(), -(int) task);
+  }
+}
+
+static bool check(ArgumentParser &variant, size_t task)
+{
+  for (unsigned int i = 0; i < overrides; ++i)
+  {
+    if (variant.getInt(keys[(task * 7 + i * 1237) % keyCount].c_str())
+      != -(int) task)
+    {
+      return false;
+    }
+  }
+  size_t other = (task * 7 + 1) % keyCount;
+  return variant.getInt(keys[other].c_str()) == (int) other * 2
+    || other == (task * 7 + 1237) % keyCount
+    || other == (task * 7 + 2474) % keyCount;
+}
+
+static void report(const char *name, double seconds, size_t heap,
+  size_t variants)
+{
+  printf("%-26s %10.0f ns/variant %10.0f bytes/variant\n", name,
+    seconds * 1e9 / variants, (double) heap / variants);
+}
+
+int main(int argc, char **argv)
+{
+  size_t variants = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+
+  for (unsigned int i = 0; i < keyCount; ++i)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "key%u", i);
+    keys.push_back(name);
+  }
+
+  ArgumentParser base("clone");
+  base.setStaticStrings(true);
+  for (unsigned int i = 0; i < keyCount; ++i)
+  {
+    base.Int(keys[i].c_str(), 0, "synthetic option");
+  }
+  for (unsigned int i = 0; i < keyCount; ++i)
+  {
+    base.set(keys[i].c_str(), (int) i * 2);
+  }
+  ArgumentSchema schema = base.getSchema();
+
+  bool failed = false;
+  std::vector<ArgumentParser*> parsers(variants);
+
+  size_t heapBefore = heapBytes();
+  double start = now();
+  for (size_t task = 0; task < variants; ++task)
+  {
+    parsers[task] = base.clone();
+    override(*parsers[task], task);
+  }
+  double seconds = now() - start;
+  report("clone()", seconds, heapBytes() - heapBefore, variants);
+
+  for (size_t task = 0; task < variants; ++task)
+  {
+    failed |= !check(*parsers[task], task);
+    delete parsers[task];
+  }
+
+  heapBefore = heapBytes();
+  start = now();
+  for (size_t task = 0; task < variants; ++task)
+  {
+    parsers[task] = new ArgumentParser(schema, "clone");
+    for (unsigned int i = 0; i < keyCount; ++i)
+    {
+      parsers[task]->set(keys[i].c_str(), base.getInt(keys[i].c_str()));
+    }
+    override(*parsers[task], task);
+  }
+  seconds = now() - start;
+  report("schema and set() all keys", seconds, heapBytes() - heapBefore,
+    variants);
+
+  for (size_t task = 0; task < variants; ++task)
+  {
+    failed |= !check(*parsers[task], task);
+    delete parsers[task];
+  }
+
+  if (failed)
+  {
+    fprintf(stderr, "clone: FAILED, a variant has wrong values\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * cloneshare.cpp
+ *
+ * checks clone(): a clone sees the values of the original, writes on either
+ * side don't leak to the other, repeated clones of an unchanged original share
+ * its frozen values, and reset() on a clone leaves the original alone. Exits
+ * with 1 otherwise. Run by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <Schema.hpp>
+#include <ValueSet.hpp>
+#include <cstdio>
+#include <cstring>
+
+static bool equals(const char *value, const char *expected)
+{
+  return value != NULL && strcmp(value, expected) == 0;
+}
+
+static void checkParser()
+{
+  ArgumentParser original("cloneshare");
+  original.Int("count", 1, "a number");
+  original.Int("limit", 2, "another number");
+  original.String("name", "default", "a string");
+  original.Standalones();
+
+  original.parseLine("count = 10", ArgumentParser::systemLayer);
+  original.parseLine("name = original");
+  const char *command = "--limit=20 first";
+  original.parseCommandString(command, strlen(command));
+
+  ArgumentParser *clone = original.clone();
+  check(clone->getInt("count") == 10 && clone->getInt("limit") == 20
+    && equals(clone->getCString("name"), "original"),
+    "the clone doesn't see the values of the original");
+  check(clone->getLayer("count") == ArgumentParser::systemLayer
+    && clone->getLayer("limit") == ArgumentParser::argvLayer,
+    "the clone doesn't see the layers of the original");
+  check(clone->getStandaloneCount() == 1
+    && equals(clone->getCStandalone(0), "first"),
+    "the clone doesn't see the standalones of the original");
+
+  // writes on the clone stay in the clone
+  clone->set("count", 11);
+  clone->set("name", "clone");
+  clone->clearLayer(ArgumentParser::argvLayer);
+  check(original.getInt("count") == 10
+    && equals(original.getCString("name"), "original")
+    && original.getInt("limit") == 20,
+    "a write on the clone leaked into the original");
+
+  // writes on the original stay in the original
+  original.set("limit", 21);
+  original.set("name", "changed");
+  check(clone->getInt("limit") == 2 && !clone->wasValueSet("limit")
+    && equals(clone->getCString("name"), "clone"),
+    "a write on the original leaked into the clone");
+  check(clone->getInt("count") == 11, "the clone lost its own value");
+
+  // reset() drops the shared values of the clone only
+  ArgumentParser *second = original.clone();
+  second->reset();
+  check(!second->wasValueSet("count") && second->getInt("count") == 1
+    && second->getStandaloneCount() == 0, "reset() kept values of the clone");
+  second->set("count", 12);
+  check(original.getInt("count") == 10 && original.getInt("limit") == 21
+    && equals(original.getCString("name"), "changed")
+    && original.getStandaloneCount() == 1,
+    "reset() on a clone changed the original");
+  check(clone->getInt("count") == 11, "reset() on a clone changed a clone");
+
+  delete second;
+  delete clone;
+}
+
+static void checkValueSet()
+{
+  Schema *schema = new Schema();
+  for (int i = 0; i < 100; ++i)
+  {
+    char key[16];
+    sprintf(key, "key%d", i);
+    schema->registerArgument(key, Argument::intType);
+  }
+
+  ValueSet original;
+  original.update(*schema);
+  original.set(0, ArgumentParser::runtimeLayer, 10);
+
+  // clones of an unchanged original all share the same frozen level
+  ValueSet first, second, third;
+  first.share(original);
+  second.share(original);
+  third.share(original);
+  const void *frozen = original.sharedValues();
+  check(frozen != NULL && first.sharedValues() == frozen
+    && second.sharedValues() == frozen && third.sharedValues() == frozen,
+    "repeated clones don't share the frozen values");
+
+  // a change on a clone doesn't refreeze the original
+  first.set(1, ArgumentParser::runtimeLayer, 11);
+  ValueSet fourth;
+  fourth.share(original);
+  check(fourth.sharedValues() == frozen,
+    "a write on a clone refroze the original");
+
+  // once the original changed, the next clone gets a new level
+  original.set(2, ArgumentParser::runtimeLayer, 12);
+  ValueSet fifth;
+  fifth.share(original);
+  check(fifth.sharedValues() != frozen && fifth[2].getInt() == 12
+    && !second.isSet(2), "a clone after a change shares stale values");
+
+  // the frozen level outlives the sets that froze it
+  original.reset();
+  second.reset();
+  check(third.sharedValues() == frozen && third[0].getInt() == 10
+    && !third.isSet(1), "reset() released values that are still shared");
+
+  schema->release();
+}
+
+int main()
+{
+  checkParser();
+  checkValueSet();
+
+  return checkResult();
+}
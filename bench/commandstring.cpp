@@ -0,0 +1,104 @@
+/*
+ * commandstring.cpp
+ *
+ * throughput of parseCommandString(), compared to splitting the command
+ * string into a char** first and calling parseArgs()
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <time.h>
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void registerOptions(ArgumentParser &args)
+{
+  args.Bool("verbose", false, "verbose output", 'v');
+  args.Int("level", 0, "some level", 'l');
+  args.UInt("threads", 1u, "number of threads", 't');
+  args.Double("ratio", 0.5, "some ratio", 'r');
+  args.String("name", "", "a name", 'n');
+  args.String("path", "", "a path", 'p');
+  args.Standalones(-1, "file", "input files");
+}
+
+// naive splitting at blanks, as done by callers before parseCommandString()
+static int split(const std::string &command, std::vector<char> &buffer,
+  std::vector<char*> &argv)
+{
+  buffer.assign(command.begin(), command.end());
+  buffer.push_back('\0');
+  argv.clear();
+  argv.push_back(const_cast<char*>("bench"));
+
+  char *word = strtok(&buffer[0], " ");
+  while (word != NULL)
+  {
+    argv.push_back(word);
+    word = strtok(NULL, " ");
+  }
+
+  return argv.size();
+}
+
+int main(int argc, char **argv)
+{
+  unsigned int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+
+  std::string command = "--verbose --level 3 -t 8 --ratio=0.25 "
+    "--name \"some quoted name\" -p '/tmp/a path/with spaces' "
+    "input1.txt input2.txt input3.txt input\\ 4.txt";
+  // the naive splitter can't handle quotes
+  std::string unquoted = "--verbose --level 3 -t 8 --ratio=0.25 "
+    "--name some_name -p /tmp/a_path/without_spaces "
+    "input1.txt input2.txt input3.txt input_4.txt";
+
+  ArgumentParser args("bench");
+  registerOptions(args);
+
+  double start = now();
+  for (unsigned int i = 0; i < iterations; ++i)
+  {
+    args.reset();
+    args.parseCommandString(command.c_str(), command.size());
+  }
+  double commandTime = now() - start;
+
+  std::vector<char> buffer;
+  std::vector<char*> words;
+  start = now();
+  for (unsigned int i = 0; i < iterations; ++i)
+  {
+    args.reset();
+    int count = split(unquoted, buffer, words);
+    args.parseArgs(count, &words[0]);
+  }
+  double argvTime = now() - start;
+
+  if (args.getStandaloneCount() != 4 || args.getUInt("threads") != 8)
+  {
+    fprintf(stderr, "unexpected parse result\n");
+    return 1;
+  }
+
+  printf("%-24s %10.1f ns/op %10.1f MB/s\n", "parseCommandString",
+    commandTime * 1e9 / iterations,
+    command.size() * iterations / commandTime / 1e6);
+  printf("%-24s %10.1f ns/op %10.1f MB/s\n", "split + parseArgs",
+    argvTime * 1e9 / iterations,
+    unquoted.size() * iterations / argvTime / 1e6);
+
+  return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * complete.cpp
+ *
+ * wall-clock time of 'prog --complete ...' queries for a tool with 5000
+ * options: answered by ArgumentParser::complete() from a prebuilt index,
+ * compared to registering all options and answering from parseArgs(). Every
+ * query is a fresh process, like a shell runs it, so the time of a process
+ * that exits right away is measured as well. Exits with 1 if the answers
+ * differ.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static const unsigned int keyCount = 5000;
+static const unsigned int queries = 200;
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void noOptions(ArgumentParser &, void *)
+{
+}
+
+static void registerOptions(ArgumentParser &args)
+{
+  args.setStaticStrings(true);
+  for (unsigned int key = 0; key < keyCount; ++key)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "option%u", key);
+    if (key % 2 == 0)
+    {
+      args.Bool(name, false, "some switch");
+    } else
+    {
+      args.Int(name, 0, "some value");
+    }
+  }
+  args.addSubcommand("build", noOptions);
+  args.addSubcommand("bench", noOptions);
+}
+
+// runs this program in a mode, returns the seconds per query
+static double measure(const char *mode, const char *word, const char *output)
+{
+  setenv("COMPLETE_BENCH_MODE", mode, 1);
+
+  double start = now();
+  for (unsigned int i = 0; i < queries; ++i)
+  {
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+      dup2(fd, STDOUT_FILENO);
+      close(fd);
+      execl("/proc/self/exe", "complete", "--complete", word, (char*) NULL);
+      _exit(127);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      fprintf(stderr, "complete: '%s' query failed\n", mode);
+      exit(1);
+    }
+  }
+
+  return (now() - start) / queries;
+}
+
+static std::string readFile(const char *filename)
+{
+  std::string contents;
+  FILE *file = fopen(filename, "r");
+  if (file != NULL)
+  {
+    char buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0)
+    {
+      contents.append(buffer, size);
+    }
+    fclose(file);
+  }
+
+  return contents;
+}
+
+int main(int argc, char **argv)
+{
+  const char *mode = getenv("COMPLETE_BENCH_MODE");
+  const char *indexFile = getenv("COMPLETE_BENCH_INDEX");
+  if (mode != NULL && indexFile != NULL)
+  {
+    if (strcmp(mode, "empty") == 0)
+    {
+      return 0;
+    }
+
+    if (strcmp(mode, "index") == 0)
+    {
+      ArgumentParser::complete(argc, argv, indexFile);
+      return 1;
+    }
+
+    ArgumentParser args("complete");
+    registerOptions(args);
+    args.parseArgs(argc, argv);
+    return 1;
+  }
+
+  char indexName[] = "/tmp/argumentparser-complete-XXXXXX";
+  char outputName[] = "/tmp/argumentparser-complete-output-XXXXXX";
+  int indexFd = mkstemp(indexName);
+  int outputFd = mkstemp(outputName);
+  if (indexFd < 0 || outputFd < 0)
+  {
+    fprintf(stderr, "complete: can't create temporary files\n");
+    return 1;
+  }
+  close(indexFd);
+  close(outputFd);
+
+  {
+    ArgumentParser args("complete");
+    registerOptions(args);
+    if (args.writeCompletionIndex(indexName))
+    {
+      return 1;
+    }
+  }
+  setenv("COMPLETE_BENCH_INDEX", indexName, 1);
+
+  double empty = measure("empty", "--option49", outputName);
+
+  const char *words[] = { "--option49", "--opt", "b" };
+  bool failed = false;
+  double indexed = 0;
+  double registered = 0;
+  for (unsigned int w = 0; w < 3; ++w)
+  {
+    indexed += measure("index", words[w], outputName);
+    std::string indexAnswer = readFile(outputName);
+
+    registered += measure("register", words[w], outputName);
+    std::string registeredAnswer = readFile(outputName);
+
+    if (indexAnswer != registeredAnswer || indexAnswer.empty())
+    {
+      failed = true;
+    }
+  }
+  indexed /= 3;
+  registered /= 3;
+
+  printf("process without query %10.3f ms\n", empty * 1e3);
+  printf("complete() from index %10.3f ms, %.3f ms over an empty process\n",
+    indexed * 1e3, (indexed - empty) * 1e3);
+  printf("parseArgs() fallback  %10.3f ms, %.3f ms over an empty process\n",
+    registered * 1e3, (registered - empty) * 1e3);
+
+  unlink(indexName);
+  unlink(outputName);
+
+  if (failed)
+  {
+    fprintf(stderr, "complete: FAILED, the answers differ\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * constraints.cpp
+ *
+ * checks registerRequirement(), registerConflict() and checkConstraints(): a
+ * requirement is met by a value or a default, a conflict only by explicit
+ * values, and constraints only apply once their key has a value. Exits with
+ * 1 otherwise. Run by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstring>
+
+static void setUp(ArgumentParser &args)
+{
+  args.String("output", "file to write", 'o');
+  args.String("format", "format of the output", 'f');
+  args.Int("level", 6, "compression level");
+  args.Bool("quiet", false, "no output");
+  args.Bool("verbose", false, "more output");
+
+  args.registerRequirement("output", "format");
+  args.registerRequirement("output", "level");
+  args.registerConflict("quiet", "verbose");
+}
+
+// the result of checkConstraints() after parsing commandString
+static bool constraintsMet(const char *commandString, bool verbose = true)
+{
+  ArgumentParser args("constraints");
+  setUp(args);
+  args.parseCommandString(commandString, strlen(commandString));
+  return args.checkConstraints(verbose);
+}
+
+int main()
+{
+  check(constraintsMet(""), "constraints of unset keys were checked");
+  check(constraintsMet("--format=gz --verbose"),
+    "constraints of unset keys were checked");
+
+  // requirements, level only has its default
+  check(constraintsMet("--output=out --format=gz"),
+    "a met requirement failed, or a default didn't count as present");
+  check(constraintsMet("--output=out --format=gz --level=9"),
+    "a met requirement failed");
+  fprintf(stderr, "expected: --output requires --format\n");
+  check(!constraintsMet("--output=out --level=9"),
+    "an unmet requirement passed");
+  check(!constraintsMet("--output=out", false),
+    "an unmet requirement passed when not verbose");
+
+  // conflicts, verbose only has its default
+  check(constraintsMet("--quiet"), "a default counted as a conflict");
+  check(constraintsMet("--verbose"), "a conflict without its key failed");
+  fprintf(stderr, "expected: --quiet conflicts with --verbose\n");
+  check(!constraintsMet("--quiet --verbose"), "a conflict passed");
+  check(!constraintsMet("--verbose=false --quiet", false),
+    "an explicit value equal to the default didn't conflict");
+
+  // every violation fails, not just the first one
+  fprintf(stderr, "expected: --output requires --format, --quiet conflicts "
+    "with --verbose\n");
+  check(!constraintsMet("--output=out --quiet --verbose"),
+    "violations of two keys passed");
+
+  // clearing the value of a key lifts its constraints
+  {
+    ArgumentParser args("constraints");
+    setUp(args);
+    const char *command = "--output=out --quiet";
+    args.parseCommandString(command, strlen(command));
+    args.parseLine("verbose = true");
+    check(!args.checkConstraints(false), "a conflict across layers passed");
+
+    args.clearLayer(ArgumentParser::argvLayer);
+    check(args.checkConstraints(), "a cleared key kept its constraints");
+    args.set("output", "out");
+    args.parseLine("format = gz");
+    check(args.checkConstraints(), "a requirement across layers failed");
+
+    args.reset();
+    check(args.checkConstraints(), "reset() kept the constrained values");
+  }
+
+  // unknown keys are rejected and add no constraint
+  {
+    ArgumentParser args("constraints");
+    setUp(args);
+    fprintf(stderr, "expected: two unknown keys\n");
+    args.registerRequirement("format", "missing");
+    args.registerConflict("missing", "format");
+    const char *command = "--format=gz";
+    args.parseCommandString(command, strlen(command));
+    check(args.checkConstraints(), "an unknown key added a constraint");
+  }
+
+  return checkResult();
+}
@@ -0,0 +1,92 @@
+/*
+ * environment.cpp
+ *
+ * checks parseEnvironment(): only PREFIX_ variables are read, lowerCase and
+ * exactCase map the names to keys as documented, and '_' or '__' maps to the
+ * '.' of a dotted key. Exits with 1 otherwise. Run by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdlib>
+#include <cstring>
+
+static bool equals(const char *value, const char *expected)
+{
+  return value != NULL && strcmp(value, expected) == 0;
+}
+
+static void setUp(ArgumentParser &args)
+{
+  args.Int("threads", 1, "worker threads");
+  args.Int("server.port", 8080, "port to listen on");
+  args.String("server.host", "localhost", "host to listen on");
+  args.String("Mode", "slow", "a key with an upper case letter");
+}
+
+int main()
+{
+  setenv("ENVCHECK_THREADS", "8", 1);
+  setenv("ENVCHECK_SERVER_PORT", "80", 1);
+  setenv("ENVCHECK_SERVER__HOST", "example.org", 1);
+  setenv("ENVCHECK_Mode", "fast", 1);
+  setenv("ENVCHECK_UNKNOWN", "1", 1);
+  // bytes beyond ASCII must not upset the lowercasing
+  setenv("ENVCHECK_\xc3\x84\xff", "1", 1);
+
+  // the prefix filter
+  setenv("ENVCHECKX_SERVER_PORT", "1", 1);
+  setenv("OTHER_SERVER_PORT", "2", 1);
+  setenv("ENVCHECK", "3", 1);
+
+  {
+    ArgumentParser args("environment");
+    setUp(args);
+    args.parseEnvironment("ENVCHECK");
+    check(args.getInt("threads") == 8
+      && args.getLayer("threads") == ArgumentParser::environmentLayer,
+      "lowerCase didn't map THREADS to threads");
+    check(args.getInt("server.port") == 80, "'_' didn't map to '.'");
+    check(equals(args.getCString("server.host"), "example.org"),
+      "'__' didn't map to '.'");
+    check(!args.wasValueSet("Mode"), "lowerCase matched a key with capitals");
+  }
+
+  {
+    ArgumentParser args("environment");
+    setUp(args);
+    args.parseEnvironment("ENVCHECK", ArgumentParser::exactCase);
+    check(equals(args.getCString("Mode"), "fast"),
+      "exactCase didn't map Mode to Mode");
+    check(!args.wasValueSet("threads") && !args.wasValueSet("server.port")
+      && !args.wasValueSet("server.host"),
+      "exactCase matched a key of another case");
+  }
+
+  // without ENVCHECK_SERVER_PORT, only variables of other prefixes are left
+  unsetenv("ENVCHECK_SERVER_PORT");
+  {
+    ArgumentParser args("environment");
+    setUp(args);
+    args.parseEnvironment("ENVCHECK");
+    check(!args.wasValueSet("server.port")
+      && args.getInt("server.port") == 8080,
+      "a variable of another prefix was read");
+    check(args.getInt("threads") == 8, "the prefix filter dropped a variable");
+  }
+
+  // no prefix matches every variable
+  {
+    ArgumentParser args("environment");
+    setUp(args);
+    setenv("THREADS", "4", 1);
+    args.parseEnvironment(NULL);
+    check(args.getInt("threads") == 4, "no prefix didn't match THREADS");
+    unsetenv("THREADS");
+  }
+
+  return checkResult();
+}
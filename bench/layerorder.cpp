@@ -0,0 +1,198 @@
+/*
+ * layerorder.cpp
+ *
+ * checks the value layers: a lower layer never overrides a higher one, writes
+ * under an overriding layer don't fire callbacks, and clearLayer() only
+ * commits the keys whose effective value changed. Reloading a layer again and
+ * again must not grow the memory of the parser. Exits with 1 otherwise. Run
+ * by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+enum Key
+{
+  top, middle, bottom, argvOnly, keyCount
+};
+
+static const char *keys[keyCount] = { "top", "middle", "bottom", "argvonly" };
+static const Key keyData[keyCount] = { top, middle, bottom, argvOnly };
+static int targets[keyCount];
+static int calls[keyCount];
+static int lastValues[keyCount];
+
+// data is the Key
+static void count(const ArgumentParser::Event &event)
+{
+  const Key *key = static_cast<const Key*>(event.data);
+  ++calls[*key];
+  lastValues[*key] = event.value.intValue;
+}
+
+// poisons the targets and forgets the callbacks, so the next check only sees
+// the keys that were committed since
+static void forget()
+{
+  for (int i = 0; i < keyCount; ++i)
+  {
+    targets[i] = -1;
+    calls[i] = 0;
+  }
+}
+
+// value and layer of a key, and whether it was committed since forget()
+static void expect(ArgumentParser &args, Key key, int value,
+  ArgumentParser::Layer layer, bool committed, const char *what)
+{
+  char message[128];
+  sprintf(message, "%s: %s", what, keys[key]);
+
+  check(args.getInt(keys[key]) == value && args.getLayer(keys[key]) == layer,
+    message);
+  if (committed)
+  {
+    check(targets[key] == value && calls[key] == 1 && lastValues[key] == value,
+      message);
+  } else
+  {
+    check(targets[key] == -1 && calls[key] == 0, message);
+  }
+}
+
+// clears and reparses the user and system layers like a reload does, and
+// overwrites a runtime value. The strings differ in length from reload to
+// reload
+static void reload(ArgumentParser &args, const char *file, int generation)
+{
+  char line[64];
+  args.beginBatch();
+  args.clearLayer(ArgumentParser::systemLayer);
+  args.parseFile(file, ArgumentParser::systemLayer);
+  args.clearLayer(ArgumentParser::userLayer);
+  sprintf(line, "path = /var/lib/%0*d", generation % 40 + 1, generation);
+  args.parseLine(line);
+  sprintf(line, "%0*d", generation % 30 + 1, generation);
+  args.set("name", line);
+  args.commitBatch();
+}
+
+static void checkReloads()
+{
+  char file[] = "/tmp/layerorderXXXXXX";
+  int fd = mkstemp(file);
+  const char *content = "host = example.org\n";
+  if (fd < 0 || write(fd, content, strlen(content)) < 0)
+  {
+    check(false, "can't write the config file");
+    return;
+  }
+  close(fd);
+
+  ArgumentParser args("layerorder");
+  args.String("host", "localhost", "a string of the system layer");
+  args.String("path", "/tmp", "a string of the user layer");
+  args.String("name", "", "a string of the runtime layer");
+
+  int generation = 0;
+  for (; generation < 1000; ++generation)
+  {
+    reload(args, file, generation);
+  }
+  size_t buffers = args.memoryUsage().buffers;
+
+  for (; generation < 100000; ++generation)
+  {
+    reload(args, file, generation);
+  }
+  unlink(file);
+  printf("buffers after 1000 reloads: %zu, after %d: %zu\n", buffers,
+    generation, args.memoryUsage().buffers);
+  check(args.memoryUsage().buffers == buffers, "reloads grow the buffers");
+}
+
+int main()
+{
+  ArgumentParser args("layerorder");
+  for (int i = 0; i < keyCount; ++i)
+  {
+    args.Int(keys[i], 0, "key", '\0', &targets[i]);
+    args.registerCallback(keys[i], count,
+      const_cast<Key*>(&keyData[i]));
+  }
+
+  // from the highest layer to the lowest, so each write lands under a layer
+  // that already has a value
+  forget();
+  args.set("top", 5);
+
+  char arg0[] = "layerorder", arg1[] = "--top=4", arg2[] = "--argvonly=7";
+  char *argv[] = { arg0, arg1, arg2 };
+  args.parseArgs(3, argv);
+
+  setenv("LAYERORDER_TOP", "3", 1);
+  setenv("LAYERORDER_MIDDLE", "3", 1);
+  args.parseEnvironment("LAYERORDER");
+
+  args.parseLine("top = 2");
+  args.parseLine("middle = 2");
+
+  args.parseLine("top = 1", ArgumentParser::systemLayer);
+  args.parseLine("middle = 1", ArgumentParser::systemLayer);
+  args.parseLine("bottom = 1", ArgumentParser::systemLayer);
+
+  expect(args, top, 5, ArgumentParser::runtimeLayer, true, "parse");
+  expect(args, middle, 3, ArgumentParser::environmentLayer, true, "parse");
+  expect(args, bottom, 1, ArgumentParser::systemLayer, true, "parse");
+  expect(args, argvOnly, 7, ArgumentParser::argvLayer, true, "parse");
+
+  // top is still overridden by runtime, argvonly falls back to its default
+  forget();
+  args.clearLayer(ArgumentParser::argvLayer);
+  expect(args, top, 5, ArgumentParser::runtimeLayer, false, "clear argv");
+  expect(args, middle, 3, ArgumentParser::environmentLayer, false,
+    "clear argv");
+  expect(args, bottom, 1, ArgumentParser::systemLayer, false, "clear argv");
+  expect(args, argvOnly, 0, ArgumentParser::defaultLayer, true, "clear argv");
+
+  forget();
+  args.clearLayer(ArgumentParser::runtimeLayer);
+  expect(args, top, 3, ArgumentParser::environmentLayer, true,
+    "clear runtime");
+  expect(args, middle, 3, ArgumentParser::environmentLayer, false,
+    "clear runtime");
+  expect(args, bottom, 1, ArgumentParser::systemLayer, false, "clear runtime");
+
+  forget();
+  args.clearLayer(ArgumentParser::environmentLayer);
+  expect(args, top, 2, ArgumentParser::userLayer, true, "clear environment");
+  expect(args, middle, 2, ArgumentParser::userLayer, true,
+    "clear environment");
+  expect(args, bottom, 1, ArgumentParser::systemLayer, false,
+    "clear environment");
+
+  // the system layer is overridden everywhere but in bottom
+  forget();
+  args.clearLayer(ArgumentParser::systemLayer);
+  expect(args, top, 2, ArgumentParser::userLayer, false, "clear system");
+  expect(args, middle, 2, ArgumentParser::userLayer, false, "clear system");
+  expect(args, bottom, 0, ArgumentParser::defaultLayer, true, "clear system");
+
+  // a higher layer overrides a lower one at once
+  forget();
+  args.parseLine("bottom = 6", ArgumentParser::systemLayer);
+  args.parseLine("bottom = 8");
+  check(targets[bottom] == 8 && calls[bottom] == 2 && lastValues[bottom] == 8,
+    "user over system: bottom");
+
+  checkReloads();
+
+  return checkResult();
+}
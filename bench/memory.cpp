@@ -0,0 +1,190 @@
+/*
+ * memory.cpp
+ *
+ * bytes per option of synthetic schemas, as reported by memoryUsage() and as
+ * measured on the heap, and time and cache misses per value of a bulk get
+ * over all options, through the get functions and the fast path. Cache
+ * misses are read from the hardware counters, n/a if the kernel doesn't
+ * provide them.
+ *
+ * usage: memory [maxKeys]
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <ArgumentParserFast.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <malloc.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t heapBytes()
+{
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// last level cache misses of this thread, -1 if there's no counter
+class CacheMisses
+{
+  int fd;
+
+public:
+  CacheMisses()
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  ~CacheMisses()
+  {
+    if (fd >= 0)
+    {
+      close(fd);
+    }
+  }
+
+  void start()
+  {
+    if (fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  long long stop()
+  {
+    long long count = -1;
+    if (fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &count, sizeof(count)) != sizeof(count))
+      {
+        count = -1;
+      }
+    }
+    return count;
+  }
+};
+
+static void report(const char *name, size_t keys, double seconds,
+  long long misses, size_t gets)
+{
+  printf("%-22s %8lu %10.1f ns/get", name, (unsigned long) keys,
+    seconds * 1e9 / gets);
+  if (misses < 0)
+  {
+    printf("  cache misses/get n/a\n");
+  } else
+  {
+    printf("  cache misses/get %.3f\n", (double) misses / gets);
+  }
+}
+
+static void bench(size_t size)
+{
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < size; ++i)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "key%lu", (unsigned long) i);
+    keys.push_back(name);
+  }
+
+  size_t heapBefore = heapBytes();
+  ArgumentParser *args = new ArgumentParser("bench");
+  args->setStaticStrings(true);
+  for (size_t i = 0; i < size; ++i)
+  {
+    args->Int(keys[i].c_str(), (int) i, "synthetic option");
+  }
+  size_t heap = heapBytes() - heapBefore;
+
+  MemoryUsage usage = args->memoryUsage();
+  printf("%lu options, bytes per option:\n", (unsigned long) size);
+  printf("  options %.1f, key index %.1f, strings %.1f, values %.1f, "
+    "buffers %.1f\n", (double) usage.options / size,
+    (double) usage.keyIndex / size, (double) usage.strings / size,
+    (double) usage.values / size, (double) usage.buffers / size);
+  printf("  memoryUsage() %.1f, heap %.1f\n", (double) usage.total / size,
+    (double) heap / size);
+
+  size_t reps = 2000000 / size + 1;
+  long long sum = 0;
+  CacheMisses misses;
+
+  double start = now();
+  misses.start();
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      sum += args->getInt(keys[i].c_str());
+    }
+  }
+  long long count = misses.stop();
+  report("get", size, now() - start, count, reps * size);
+
+  ArgumentParserFast fast(*args);
+  std::vector<ArgumentParserFast::Handle> handles;
+  for (size_t i = 0; i < size; ++i)
+  {
+    handles.push_back(fast.handle(keys[i].c_str()));
+  }
+
+  start = now();
+  misses.start();
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      sum += fast.getInt(handles[i]);
+    }
+  }
+  count = misses.stop();
+  report("get (fast path)", size, now() - start, count, reps * size);
+
+  if (sum == 0)
+  {
+    fprintf(stderr, "memory: unexpected values\n");
+  }
+
+  delete args;
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  size_t maxKeys = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+
+  for (size_t size = 1000; size <= maxKeys; size *= 100)
+  {
+    bench(size);
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * parsefiles.cpp
+ *
+ * wall-clock time of parseFiles() compared to consecutive parseFile() calls
+ * for several config files with overlapping keys. Both have to produce the
+ * same values, otherwise the benchmark exits with 1.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const unsigned int keyCount = 1000;
+
+static std::string keyName(unsigned int key)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "key%u", key);
+  return name;
+}
+
+static void registerOptions(ArgumentParser &args)
+{
+  for (unsigned int key = 0; key < keyCount; ++key)
+  {
+    args.Int(keyName(key).c_str(), 0, "some value");
+  }
+}
+
+int main(int argc, char **argv)
+{
+  unsigned int fileCount = argc > 1 ? atoi(argv[1]) : 8;
+  unsigned int lineCount = argc > 2 ? atoi(argv[2]) : 200000;
+
+  // file f sets every key, each one several times with values of its own
+  std::vector<std::string> names;
+  for (unsigned int f = 0; f < fileCount; ++f)
+  {
+    char name[] = "/tmp/argumentparser-parsefiles-XXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0)
+    {
+      fprintf(stderr, "parsefiles: can't create a config file\n");
+      return 1;
+    }
+    FILE *file = fdopen(fd, "w");
+    for (unsigned int line = 0; line < lineCount; ++line)
+    {
+      fprintf(file, "%s = %u\n", keyName(line % keyCount).c_str(),
+        f * lineCount + line);
+    }
+    fclose(file);
+    names.push_back(name);
+  }
+
+  std::vector<const char*> filenames;
+  for (unsigned int f = 0; f < fileCount; ++f)
+  {
+    filenames.push_back(names[f].c_str());
+  }
+
+  ArgumentParser serial("bench");
+  registerOptions(serial);
+  double start = now();
+  for (unsigned int f = 0; f < fileCount; ++f)
+  {
+    serial.parseFile(filenames[f]);
+  }
+  double serialTime = now() - start;
+
+  ArgumentParser parallel("bench");
+  registerOptions(parallel);
+  start = now();
+  parallel.parseFiles(&filenames[0], fileCount);
+  double parallelTime = now() - start;
+
+  bool failed = false;
+  for (unsigned int key = 0; key < keyCount; ++key)
+  {
+    std::string name = keyName(key);
+    if (serial.getInt(name.c_str()) != parallel.getInt(name.c_str()))
+    {
+      failed = true;
+    }
+  }
+
+  for (unsigned int f = 0; f < fileCount; ++f)
+  {
+    unlink(filenames[f]);
+  }
+
+  printf("%u files x %u lines\n", fileCount, lineCount);
+  printf("parseFile (serial)   %8.1f ms\n", serialTime * 1e3);
+  printf("parseFiles           %8.1f ms\n", parallelTime * 1e3);
+
+  if (failed)
+  {
+    fprintf(stderr, "parsefiles: FAILED, values differ from serial parsing\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,537 @@
+/*
+ * phases.cpp
+ *
+ * time, bytes and allocations per operation of every parser phase, for
+ * synthetic schemas of different sizes. getopt_long() parses the same command
+ * lines as a baseline.
+ *
+ * usage: phases [maxKeys [fileMB]]
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "alloccount.hpp"
+#include <ArgumentParser.h>
+#include <ArgumentParserFast.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// one timed phase
+class Measurement
+{
+  double start;
+  AllocStats allocs;
+
+public:
+  Measurement() :
+    start(0)
+  {
+    allocs = allocStats();
+    start = now();
+  }
+
+  void report(const char *phase, size_t keys, size_t ops, const char *unit)
+  {
+    double seconds = now() - start;
+    AllocStats end = allocStats();
+
+    if (ops == 0)
+    {
+      ops = 1;
+    }
+
+    printf("%-22s %8lu %12.1f", phase, (unsigned long) keys,
+      seconds * 1e9 / ops);
+    if (allocCountingEnabled())
+    {
+      printf(" %12.1f %12.3f", double(end.bytes - allocs.bytes) / ops,
+        double(end.count - allocs.count) / ops);
+    } else
+    {
+      printf(" %12s %12s", "-", "-");
+    }
+    printf("  %s\n", unit);
+  }
+};
+
+static void skip(const char *phase, size_t keys, const char *reason)
+{
+  printf("%-22s %8lu %12s %12s %12s  (%s)\n", phase, (unsigned long) keys, "-",
+    "-", "-", reason);
+}
+
+/*
+ * synthetic schema: keys "key0" ... "keyN", cycling through the value types
+ */
+enum KeyType
+{
+  boolKey, intKey, uintKey, doubleKey, stringKey, keyTypes
+};
+
+static KeyType keyType(size_t index)
+{
+  return KeyType(index % keyTypes);
+}
+
+static const char *values[keyTypes] = { "true", "42", "7", "0.25", "value" };
+
+struct SyntheticSchema
+{
+  std::vector<std::string> keys;
+  std::vector<std::string> comments;
+
+  SyntheticSchema(size_t size)
+  {
+    char buffer[64];
+    for (size_t i = 0; i < size; ++i)
+    {
+      snprintf(buffer, sizeof(buffer), "key%lu", (unsigned long) i);
+      keys.push_back(buffer);
+      snprintf(buffer, sizeof(buffer), "synthetic option #%lu",
+        (unsigned long) i);
+      comments.push_back(buffer);
+    }
+  }
+
+  size_t size() const
+  {
+    return keys.size();
+  }
+};
+
+static void registerSchema(ArgumentParser &args, const SyntheticSchema &schema)
+{
+  for (size_t i = 0; i < schema.size(); ++i)
+  {
+    const char *key = schema.keys[i].c_str();
+    const char *comment = schema.comments[i].c_str();
+    switch (keyType(i))
+    {
+    case boolKey:
+      args.Bool(key, false, comment);
+      break;
+    case intKey:
+      args.Int(key, 0, comment);
+      break;
+    case uintKey:
+      args.UInt(key, 0u, comment);
+      break;
+    case doubleKey:
+      args.Double(key, 0.0, comment);
+      break;
+    default:
+      args.String(key, "", comment);
+      break;
+    }
+  }
+}
+
+// "--keyN value" for every key, "--keyN" alone for bools
+struct CommandLine
+{
+  std::vector<std::string> words;
+  std::vector<char*> argv;
+
+  CommandLine(const SyntheticSchema &schema)
+  {
+    words.push_back("bench");
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+      words.push_back("--" + schema.keys[i]);
+      if (keyType(i) != boolKey)
+      {
+        words.push_back(values[keyType(i)]);
+      }
+    }
+
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+      argv.push_back(&words[i][0]);
+    }
+    argv.push_back(NULL);
+  }
+
+  int argc() const
+  {
+    return argv.size() - 1;
+  }
+};
+
+static size_t repetitions(size_t opsPerRun, size_t targetOps)
+{
+  size_t reps = targetOps / (opsPerRun ? opsPerRun : 1);
+  return reps ? reps : 1;
+}
+
+static const size_t targetOps = 200000;
+
+static void benchRegistration(const SyntheticSchema &schema)
+{
+  size_t reps = repetitions(schema.size(), targetOps);
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    ArgumentParser args("bench");
+    registerSchema(args, schema);
+  }
+  measurement.report("register", schema.size(), reps * schema.size(), "key");
+}
+
+static void benchParseArgs(ArgumentParser &args, const SyntheticSchema &schema)
+{
+  CommandLine line(schema);
+  size_t reps = repetitions(schema.size(), targetOps);
+
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    args.reset();
+    args.parseArgs(line.argc(), &line.argv[0]);
+  }
+  measurement.report("parseArgs", schema.size(), reps * schema.size(), "key");
+}
+
+static void benchGetoptLong(const SyntheticSchema &schema)
+{
+  if (schema.size() > 10000)
+  {
+    // getopt_long() searches the options linearly
+    skip("getopt_long", schema.size(), "quadratic, skipped");
+    return;
+  }
+
+  std::vector<struct option> options;
+  for (size_t i = 0; i < schema.size(); ++i)
+  {
+    struct option option;
+    option.name = schema.keys[i].c_str();
+    option.has_arg = keyType(i) == boolKey ? no_argument : required_argument;
+    option.flag = NULL;
+    option.val = 0;
+    options.push_back(option);
+  }
+  struct option last = { NULL, 0, NULL, 0 };
+  options.push_back(last);
+
+  CommandLine line(schema);
+  size_t reps = repetitions(schema.size(), targetOps);
+  size_t found = 0;
+
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    optind = 0;
+    int index;
+    while (getopt_long(line.argc(), &line.argv[0], "", &options[0], &index)
+      != -1)
+    {
+      ++found;
+    }
+  }
+  measurement.report("getopt_long", schema.size(), reps * schema.size(),
+    "key");
+
+  if (found != reps * schema.size())
+  {
+    fprintf(stderr, "getopt_long: unexpected number of options\n");
+  }
+}
+
+static void benchParseLine(ArgumentParser &args, const SyntheticSchema &schema)
+{
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < schema.size(); ++i)
+  {
+    lines.push_back(schema.keys[i] + " = " + values[keyType(i)]);
+  }
+  size_t reps = repetitions(schema.size(), targetOps);
+
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    args.reset();
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+      args.parseLine(lines[i].c_str());
+    }
+  }
+  measurement.report("parseLine", schema.size(), reps * schema.size(),
+    "line");
+}
+
+static void benchParseFile(ArgumentParser &args, const SyntheticSchema &schema,
+  size_t fileMB)
+{
+  char filename[] = "/tmp/argumentparser-bench-XXXXXX";
+  int fd = mkstemp(filename);
+  if (fd < 0)
+  {
+    skip("parseFile", schema.size(), "can't create a temporary file");
+    return;
+  }
+
+  // cycle through the keys until the file is big enough
+  std::string block;
+  size_t lines = 0;
+  for (size_t i = 0; i < schema.size(); ++i)
+  {
+    block += schema.keys[i] + " = " + values[keyType(i)] + "\n";
+  }
+  size_t size = 0;
+  size_t linesPerBlock = schema.size();
+  while (size < fileMB << 20 || lines < schema.size())
+  {
+    if (write(fd, block.data(), block.size()) != (ssize_t) block.size())
+    {
+      close(fd);
+      unlink(filename);
+      skip("parseFile", schema.size(), "can't write the temporary file");
+      return;
+    }
+    size += block.size();
+    lines += linesPerBlock;
+  }
+  close(fd);
+
+  args.reset();
+  Measurement measurement;
+  args.parseFile(filename);
+  char unit[64];
+  snprintf(unit, sizeof(unit), "line (%lu MB)", (unsigned long) (size >> 20));
+  measurement.report("parseFile", schema.size(), lines, unit);
+
+  unlink(filename);
+}
+
+static void benchGetters(ArgumentParser &args, const SyntheticSchema &schema)
+{
+  size_t reps = repetitions(schema.size(), targetOps);
+  double sum = 0;
+
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+      const char *key = schema.keys[i].c_str();
+      switch (keyType(i))
+      {
+      case boolKey:
+        sum += args.getBool(key);
+        break;
+      case intKey:
+        sum += args.getInt(key);
+        break;
+      case uintKey:
+        sum += args.getUInt(key);
+        break;
+      case doubleKey:
+        sum += args.getDouble(key);
+        break;
+      default:
+        sum += args.getCString(key)[0];
+        break;
+      }
+    }
+  }
+  measurement.report("get", schema.size(), reps * schema.size(), "key");
+
+  if (sum == 0)
+  {
+    fprintf(stderr, "get: unexpected values\n");
+  }
+}
+
+// the same values through the inline getters, with handles looked up once
+static void benchFastGetters(ArgumentParser &args,
+  const SyntheticSchema &schema)
+{
+  ArgumentParserFast fast(args);
+  std::vector<ArgumentParserFast::Handle> handles;
+  for (size_t i = 0; i < schema.size(); ++i)
+  {
+    handles.push_back(fast.handle(schema.keys[i].c_str()));
+  }
+
+  size_t reps = repetitions(schema.size(), targetOps);
+  double sum = 0;
+
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+      switch (keyType(i))
+      {
+      case boolKey:
+        sum += fast.getBool(handles[i]);
+        break;
+      case intKey:
+        sum += fast.getInt(handles[i]);
+        break;
+      case uintKey:
+        sum += fast.getUInt(handles[i]);
+        break;
+      case doubleKey:
+        sum += fast.getDouble(handles[i]);
+        break;
+      default:
+        sum += fast.getCString(handles[i])[0];
+        break;
+      }
+    }
+  }
+  measurement.report("get (fast path)", schema.size(), reps * schema.size(),
+    "key");
+
+  if (sum == 0)
+  {
+    fprintf(stderr, "get (fast path): unexpected values\n");
+  }
+}
+
+static void countCallback(void *data)
+{
+  ++*static_cast<size_t*>(data);
+}
+
+// set() of every key, without and with a target and a callback per key
+static void benchTargets(const SyntheticSchema &schema)
+{
+  size_t reps = repetitions(schema.size(), targetOps);
+
+  ArgumentParser args("bench");
+  registerSchema(args, schema);
+
+  Measurement plain;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+      args.set(schema.keys[i].c_str(), values[keyType(i)]);
+    }
+  }
+  plain.report("set", schema.size(), reps * schema.size(), "key");
+
+  // one slot per key, big enough for every target type
+  std::vector<char> targets(schema.size() * 32);
+  size_t callbacks = 0;
+  for (size_t i = 0; i < schema.size(); ++i)
+  {
+    const char *key = schema.keys[i].c_str();
+    args.registerTarget(key, &targets[i * 32]);
+    args.registerCallback(key, countCallback, &callbacks);
+  }
+
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+      args.set(schema.keys[i].c_str(), values[keyType(i)]);
+    }
+  }
+  measurement.report("set+target+callback", schema.size(),
+    reps * schema.size(), "key");
+
+  if (callbacks != reps * schema.size())
+  {
+    fprintf(stderr, "set: unexpected number of callbacks\n");
+  }
+}
+
+static void benchWriteFile(ArgumentParser &args, const SyntheticSchema &schema)
+{
+  char filename[] = "/tmp/argumentparser-bench-XXXXXX";
+  int fd = mkstemp(filename);
+  if (fd < 0)
+  {
+    skip("writeFile", schema.size(), "can't create a temporary file");
+    return;
+  }
+  close(fd);
+
+  size_t reps = repetitions(schema.size(), targetOps / 10);
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    args.writeFile(filename);
+  }
+  measurement.report("writeFile", schema.size(), reps * schema.size(), "key");
+
+  unlink(filename);
+}
+
+static void benchHelp(ArgumentParser &args, const SyntheticSchema &schema)
+{
+  fflush(stdout);
+  int out = dup(STDOUT_FILENO);
+  int null = open("/dev/null", O_WRONLY);
+  if (out < 0 || null < 0)
+  {
+    skip("displayHelpMessage", schema.size(), "can't redirect stdout");
+    return;
+  }
+  dup2(null, STDOUT_FILENO);
+  close(null);
+
+  size_t reps = repetitions(schema.size(), targetOps / 10);
+  Measurement measurement;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    args.displayHelpMessage();
+  }
+  fflush(stdout);
+
+  dup2(out, STDOUT_FILENO);
+  close(out);
+  measurement.report("displayHelpMessage", schema.size(), reps * schema.size(),
+    "key");
+}
+
+int main(int argc, char **argv)
+{
+  size_t maxKeys = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+  size_t fileMB = argc > 2 ? strtoul(argv[2], NULL, 10) : 32;
+
+  printf("%-22s %8s %12s %12s %12s  %s\n", "phase", "keys", "ns/op", "B/op",
+    "allocs/op", "op");
+
+  for (size_t size = 10; size <= maxKeys; size *= 100)
+  {
+    SyntheticSchema schema(size);
+
+    benchRegistration(schema);
+
+    ArgumentParser args("bench");
+    registerSchema(args, schema);
+
+    benchParseArgs(args, schema);
+    benchGetoptLong(schema);
+    benchParseLine(args, schema);
+    benchParseFile(args, schema, fileMB);
+    benchGetters(args, schema);
+    benchFastGetters(args, schema);
+    benchTargets(schema);
+    benchWriteFile(args, schema);
+    benchHelp(args, schema);
+    printf("\n");
+  }
+
+  return 0;
+}
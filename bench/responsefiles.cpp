@@ -0,0 +1,172 @@
+/*
+ * responsefiles.cpp
+ *
+ * checks how command strings and @file response files are split into words:
+ * quotes and escapes, the nesting limit of response files, @missing as a
+ * literal argument, and a key at the end of a response file that takes its
+ * value from the next argument. Exits with 1 otherwise. Run by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+static std::string directory;
+
+static bool equals(const char *value, const char *expected)
+{
+  return value != NULL && strcmp(value, expected) == 0;
+}
+
+static std::string writeFile(const char *name, const char *content)
+{
+  std::string path = directory + "/" + name;
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == NULL || fputs(content, file) < 0)
+  {
+    check(false, "can't write a response file");
+  }
+  if (file != NULL)
+  {
+    fclose(file);
+  }
+
+  return path;
+}
+
+static void setUp(ArgumentParser &args)
+{
+  args.String("name", "", "a string");
+  args.String("path", "", "another string");
+  args.Int("level", 0, "depth of the response file");
+  args.Bool("verbose", false, "a switch");
+  args.Standalones();
+}
+
+static void parseArgs(ArgumentParser &args, const char *first,
+  const char *second = NULL)
+{
+  char arg0[] = "responsefiles";
+  std::string arg1 = first, arg2 = second ? second : "";
+  char *argv[] = { arg0, &arg1[0], &arg2[0] };
+  args.parseArgs(second ? 3 : 2, argv);
+}
+
+// the same words from a command string and from a response file
+static void checkWords(ArgumentParser &args, const char *where)
+{
+  std::string message = std::string(where) + ": ";
+  check(equals(args.getCString("name"), "a b"),
+    (message + "single quotes").c_str());
+  check(equals(args.getCString("path"), "x \"y\" \\z $HOME"),
+    (message + "double quotes").c_str());
+  check(args.getStandaloneCount() == 4, (message + "word count").c_str());
+  if (args.getStandaloneCount() == 4)
+  {
+    check(equals(args.getCStandalone(0), "plain word"),
+      (message + "escaped blank").c_str());
+    check(equals(args.getCStandalone(1), "it's"),
+      (message + "quotes within a word").c_str());
+    check(equals(args.getCStandalone(2), ""), (message + "empty word").c_str());
+    check(equals(args.getCStandalone(3), "tab\there"),
+      (message + "quoted tab").c_str());
+  }
+}
+
+static const char *words = "--name='a b' --path=\"x \\\"y\\\" \\\\z $HOME\"\n"
+  "  plain\\ word 'it'\\''s' \"\" 'tab\there'";
+
+static void checkQuoting()
+{
+  ArgumentParser args("responsefiles");
+  setUp(args);
+  args.parseCommandString(words, strlen(words));
+  checkWords(args, "command string");
+
+  ArgumentParser fromFile("responsefiles");
+  setUp(fromFile);
+  std::string file = "@" + writeFile("words", words);
+  parseArgs(fromFile, file.c_str());
+  checkWords(fromFile, "response file");
+}
+
+// every file sets its depth and includes the next one
+static void checkDepth()
+{
+  for (int depth = 1; depth <= 20; ++depth)
+  {
+    char name[16], content[64];
+    sprintf(name, "nested%d", depth);
+    sprintf(content, "--level=%d @%s/nested%d", depth, directory.c_str(),
+      depth + 1);
+    writeFile(name, content);
+  }
+
+  ArgumentParser args("responsefiles");
+  setUp(args);
+  std::string file = "@" + directory + "/nested1";
+  fprintf(stderr, "expected: nested too deeply\n");
+  parseArgs(args, file.c_str());
+  check(args.getInt("level") == 16,
+    "response files aren't limited to a depth of 16");
+
+  for (int depth = 1; depth <= 20; ++depth)
+  {
+    char name[16];
+    sprintf(name, "/nested%d", depth);
+    unlink((directory + name).c_str());
+  }
+}
+
+static void checkMissing()
+{
+  ArgumentParser args("responsefiles");
+  setUp(args);
+  std::string missing = "@" + directory + "/missing";
+  parseArgs(args, missing.c_str(), "@");
+  check(args.getStandaloneCount() == 2
+    && equals(args.getCStandalone(0), missing.c_str())
+    && equals(args.getCStandalone(1), "@"),
+    "@missing isn't taken literally");
+}
+
+static void checkPendingKey()
+{
+  ArgumentParser args("responsefiles");
+  setUp(args);
+  std::string file = "@" + writeFile("pending", "--verbose --name");
+  parseArgs(args, file.c_str(), "from argv");
+  check(equals(args.getCString("name"), "from argv"),
+    "a key at the end of a response file lost its value");
+  check(args.getBool("verbose") && args.getStandaloneCount() == 0,
+    "a key at the end of a response file changed the words before it");
+  unlink(file.c_str() + 1);
+}
+
+int main()
+{
+  char pattern[] = "/tmp/responsefilesXXXXXX";
+  if (mkdtemp(pattern) == NULL)
+  {
+    check(false, "can't create a directory");
+    return checkResult();
+  }
+  directory = pattern;
+
+  checkQuoting();
+  checkDepth();
+  checkMissing();
+  checkPendingKey();
+
+  unlink((directory + "/words").c_str());
+  rmdir(directory.c_str());
+
+  return checkResult();
+}
@@ -0,0 +1,104 @@
+/*
+ * sections.cpp
+ *
+ * modules that read all of their keys, for 100 modules with 100 dotted keys
+ * each (module7.key42): looking every key up by name, compared to fetching
+ * the module's section once and reading its keys through the fast path.
+ * Also times building the section index. Exits with 1 if the sums differ.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <ArgumentParserFast.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <time.h>
+
+static const unsigned int modules = 100;
+static const unsigned int keysPerModule = 100;
+static const unsigned int reps = 100;
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+  std::vector<std::string> moduleNames;
+  std::vector<std::string> keys;
+  ArgumentParser args("sections");
+  args.setStaticStrings(true);
+  for (unsigned int m = 0; m < modules; ++m)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "module%u", m);
+    moduleNames.push_back(name);
+    for (unsigned int k = 0; k < keysPerModule; ++k)
+    {
+      char key[64];
+      snprintf(key, sizeof(key), "module%u.key%u", m, k);
+      keys.push_back(key);
+    }
+  }
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    args.Int(keys[i].c_str(), (int) i, "synthetic option");
+  }
+
+  double start = now();
+  args.getSection("");
+  double build = now() - start;
+
+  long long byName = 0;
+  start = now();
+  for (unsigned int r = 0; r < reps; ++r)
+  {
+    for (unsigned int m = 0; m < modules; ++m)
+    {
+      for (unsigned int k = 0; k < keysPerModule; ++k)
+      {
+        byName += args.getInt(keys[m * keysPerModule + k].c_str());
+      }
+    }
+  }
+  double byNameSeconds = now() - start;
+
+  ArgumentParserFast fast(args);
+  long long bySection = 0;
+  start = now();
+  for (unsigned int r = 0; r < reps; ++r)
+  {
+    for (unsigned int m = 0; m < modules; ++m)
+    {
+      ArgumentSection section = args.getSection(moduleNames[m].c_str());
+      for (const ArgumentSection::Key *key = section.begin();
+        key != section.end(); ++key)
+      {
+        bySection += fast.getInt(fast.handle(*key));
+      }
+    }
+  }
+  double bySectionSeconds = now() - start;
+
+  size_t reads = (size_t) reps * modules * keysPerModule;
+  printf("section index of %lu keys   %10.3f ms\n",
+    (unsigned long) keys.size(), build * 1e3);
+  printf("get() by name              %10.1f ns/key\n",
+    byNameSeconds * 1e9 / reads);
+  printf("getSection() + fast path   %10.1f ns/key\n",
+    bySectionSeconds * 1e9 / reads);
+
+  if (byName != bySection)
+  {
+    fprintf(stderr, "sections: FAILED, the sums differ\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * snapshot.cpp
+ *
+ * stress test for ConfigView and ConfigPublisher: reader threads read the
+ * published configuration while the main thread keeps parsing and publishing
+ * new snapshots. Readers verify that they never see a mix of two versions.
+ * Exits with 1 if they do. Run by 'make check', configure with --enable-tsan
+ * to check for races as well:
+ *
+ *   ./configure --enable-tsan && make check
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static const int keyCount = 64;
+static const int readerCount = 8;
+
+static ConfigPublisher *publisher;
+static std::atomic<bool> done(false);
+static std::atomic<unsigned long> reads(0);
+static std::atomic<unsigned long> errors(0);
+
+static void keyName(char *buffer, const char *prefix, int index)
+{
+  sprintf(buffer, "%s%d", prefix, index);
+}
+
+// every value of a snapshot encodes the same generation
+static bool consistent(const ConfigView &view)
+{
+  char key[32];
+  int generation = view.getInt("generation");
+
+  for (int i = 0; i < keyCount; ++i)
+  {
+    keyName(key, "int", i);
+    if (view.getInt(key) != generation + i)
+    {
+      return false;
+    }
+    keyName(key, "double", i);
+    if (view.getDouble(key) != generation * 0.5)
+    {
+      return false;
+    }
+    keyName(key, "string", i);
+    const char *value = view.getCString(key);
+    if (value == NULL || atoi(value) != generation)
+    {
+      return false;
+    }
+  }
+
+  return view.getStandaloneCount() == 1
+    && atoi(view.getCStandalone(0)) == generation;
+}
+
+static void reader()
+{
+  while (!done.load())
+  {
+    for (int i = 0; i < 100; ++i)
+    {
+      ConfigPublisher::Guard guard(*publisher);
+      if (!consistent(*guard))
+      {
+        ++errors;
+      }
+      ++reads;
+    }
+
+    // keep a reference for longer
+    ConfigView view = publisher->get();
+    if (!consistent(view))
+    {
+      ++errors;
+    }
+    ++reads;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int generations = argc > 1 ? atoi(argv[1]) : 2000;
+
+  ArgumentParser args("stress");
+  char key[32];
+  args.Int("generation", 0, "generation of the snapshot");
+  for (int i = 0; i < keyCount; ++i)
+  {
+    keyName(key, "int", i);
+    args.Int(key, i, "int value");
+    keyName(key, "double", i);
+    args.Double(key, 0.0, "double value");
+    keyName(key, "string", i);
+    args.String(key, "0", "string value");
+  }
+  args.Standalones(1);
+
+  args.parseCommandString("0", 1);
+  publisher = new ConfigPublisher(args.snapshot());
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < readerCount; ++i)
+  {
+    readers.push_back(std::thread(reader));
+  }
+
+  char buffer[64];
+  for (int generation = 1; generation <= generations; ++generation)
+  {
+    args.reset();
+    sprintf(buffer, "--generation=%d %d", generation, generation);
+    args.parseCommandString(buffer, strlen(buffer));
+    for (int i = 0; i < keyCount; ++i)
+    {
+      keyName(key, "int", i);
+      args.set(key, generation + i);
+      keyName(key, "double", i);
+      args.set(key, generation * 0.5);
+      keyName(key, "string", i);
+      sprintf(buffer, "%d", generation);
+      args.set(key, buffer);
+    }
+
+    publisher->publish(args);
+  }
+
+  done.store(true);
+  for (int i = 0; i < readerCount; ++i)
+  {
+    readers[i].join();
+  }
+  delete publisher;
+
+  printf("%d snapshots, %lu consistent reads, %lu errors\n", generations,
+    reads.load(), errors.load());
+
+  return errors.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/*
+ * subcommandscope.cpp
+ *
+ * checks the scope of sub-commands: init only runs when the name is parsed as
+ * the first standalone, not when it's the value of an option, and the options
+ * of a command that isn't selected are rejected. Exits with 1 otherwise. Run
+ * by 'make check'.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "check.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstring>
+
+static int runInits = 0;
+static int buildInits = 0;
+
+static void initRun(ArgumentParser &args, void*)
+{
+  ++runInits;
+  args.Int("delay", 0, "seconds to wait");
+}
+
+static void initBuild(ArgumentParser &args, void*)
+{
+  ++buildInits;
+  args.Bool("release", false, "optimized build");
+}
+
+static void setUp(ArgumentParser &args)
+{
+  runInits = 0;
+  buildInits = 0;
+  args.Bool("verbose", false, "more output", 'v');
+  args.String("name", "", "name of the job");
+  args.Standalones();
+  args.addSubcommand("run", initRun, NULL, "runs the job");
+  args.addSubcommand("build", initBuild, NULL, "builds the job");
+}
+
+static void parse(ArgumentParser &args, const char *commandString)
+{
+  args.parseCommandString(commandString, strlen(commandString));
+}
+
+int main()
+{
+  // the value of an option is no command
+  {
+    ArgumentParser args("subcommandscope");
+    setUp(args);
+    parse(args, "--name run");
+    check(runInits == 0 && args.getSubcommand() == NULL,
+      "init ran for the value of a string option");
+    check(strcmp(args.getCString("name"), "run") == 0,
+      "the string option lost its value");
+  }
+  {
+    ArgumentParser args("subcommandscope");
+    setUp(args);
+    parse(args, "--verbose=run");
+    check(runInits == 0 && args.getSubcommand() == NULL,
+      "init ran for the value of a bool switch");
+    check(!args.keyExists("delay"), "options of run were registered");
+  }
+
+  // a pending bool switch doesn't take the name, the name selects the command
+  {
+    ArgumentParser args("subcommandscope");
+    setUp(args);
+    parse(args, "-v run --delay=3");
+    check(runInits == 1 && buildInits == 0
+      && strcmp(args.getSubcommand(), "run") == 0, "-v run didn't select run");
+    check(args.getBool("verbose") && args.getInt("delay") == 3,
+      "-v run --delay=3 lost a value");
+  }
+
+  // only the first standalone selects a command
+  {
+    ArgumentParser args("subcommandscope");
+    setUp(args);
+    parse(args, "first run");
+    check(runInits == 0 && args.getSubcommand() == NULL,
+      "a later standalone selected a command");
+    check(args.getStandaloneCount() == 2, "a standalone got lost");
+  }
+
+  // options of other commands are rejected, before and after the selection
+  {
+    ArgumentParser args("subcommandscope");
+    setUp(args);
+    parse(args, "--delay=3");
+    check(runInits == 0 && !args.keyExists("delay"),
+      "an option of an unselected command was accepted");
+
+    parse(args, "run --release --delay=4");
+    check(runInits == 1 && buildInits == 0,
+      "an option of build ran its init");
+    check(!args.keyExists("release"),
+      "an option of an unselected command was registered");
+    check(args.getInt("delay") == 4, "run lost its option");
+
+    // a parser selects at most one command
+    parse(args, "build");
+    check(buildInits == 0 && strcmp(args.getSubcommand(), "run") == 0,
+      "a second command was selected");
+  }
+
+  return checkResult();
+}
@@ -0,0 +1,257 @@
+/*
+ * zeroalloc.cpp
+ *
+ * checks that a warmed-up parser doesn't allocate memory: every scenario is
+ * parsed a few times to warm the parser up, then repeatedly with reset() in
+ * between, counting the allocations. Exits with 1 if there was any, so
+ * 'make check' fails, and with 77 (skipped) if allocations can't be counted.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include "alloccount.hpp"
+#include <ArgumentParser.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+static const unsigned int warmups = 3;
+static const unsigned int iterations = 1000;
+
+struct Targets
+{
+  bool verbose;
+  int level;
+  unsigned int threads;
+  double ratio;
+  char name[256];
+  std::atomic<unsigned int> rate;
+  unsigned int callbacks;
+
+  Targets() :
+    verbose(false), level(0), threads(0), ratio(0), rate(0), callbacks(0)
+  {
+    name[0] = '\0';
+  }
+};
+
+static void countCallback(void *data)
+{
+  ++static_cast<Targets*>(data)->callbacks;
+}
+
+static void registerOptions(ArgumentParser &args, Targets &targets)
+{
+  args.Bool("verbose", false, "verbose output", 'v', &targets.verbose);
+  args.Bool("quiet", false, "no output", 'q');
+  args.Int("level", 0, "some level", 'l', &targets.level);
+  args.UInt("threads", 1u, "number of threads", 't', &targets.threads);
+  args.UInt("rate", 100u, "sampling rate", 'r');
+  args.registerTarget("rate", &targets.rate);
+  args.Double("ratio", 0.5, "some ratio", 'x', &targets.ratio);
+  args.String("name", "", "a name", 'n', targets.name);
+  args.String("path", "", "a path", 'p');
+  args.Standalones(-1, "file", "input files");
+
+  args.registerCallback("level", countCallback, &targets);
+  args.registerCallback("name", countCallback, &targets);
+  args.registerCallback(NULL, countCallback, &targets);
+  args.registerCallback("threads",
+    [&targets](const ArgumentParser::Event &event)
+    {
+      targets.callbacks += event.value.uintValue;
+    });
+}
+
+// a command line that parseArgs() may modify, restored before every parse
+class CommandLine
+{
+  std::vector<std::string> original;
+  std::vector<char> buffer;
+  std::vector<char*> argv;
+
+public:
+  CommandLine(const char **words)
+  {
+    for (; *words != NULL; ++words)
+    {
+      original.push_back(*words);
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      size += original[i].size() + 1;
+    }
+    buffer.resize(size);
+    argv.resize(original.size() + 1);
+  }
+
+  char **restore()
+  {
+    char *cursor = &buffer[0];
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      memcpy(cursor, original[i].c_str(), original[i].size() + 1);
+      argv[i] = cursor;
+      cursor += original[i].size() + 1;
+    }
+    argv[original.size()] = NULL;
+
+    return &argv[0];
+  }
+
+  int argc() const
+  {
+    return original.size();
+  }
+};
+
+static const char *argvWords[] = { "zeroalloc", "--verbose", "--level", "3",
+  "-t", "8", "--ratio=0.25", "--name", "some name", "-vq", "-r=50",
+  "--path", "/tmp/a path", "input1.txt", "input2.txt", "input3.txt", NULL };
+
+static const char *lines[] = { "verbose = true", "  level = -4  ",
+  "threads=16", "ratio = 1e-3", "name = a name with blanks",
+  "# a comment", "quiet = FALSE", "path = /usr/local/share", NULL };
+
+static const char *command = "--verbose --level 3 -t 8 --ratio=0.25 "
+  "--name \"some quoted name\" -p '/tmp/a path/with spaces' "
+  "input1.txt input2.txt input\\ 3.txt";
+
+enum Scenario
+{
+  parseArgsScenario,
+  parseArgsBatchScenario,
+  parseLineScenario,
+  parseCommandStringScenario,
+  responseFileScenario,
+  environmentScenario,
+  setScenario,
+  scenarios
+};
+
+static const char *scenarioNames[scenarios] = { "parseArgs",
+  "parseArgs (batch)", "parseLine", "parseCommandString", "response file",
+  "parseEnvironment", "set" };
+
+static void run(Scenario scenario, ArgumentParser &args,
+  CommandLine &commandLine, CommandLine &responseLine)
+{
+  args.reset();
+
+  switch (scenario)
+  {
+  case parseArgsScenario:
+  case parseArgsBatchScenario:
+    args.parseArgs(commandLine.argc(), commandLine.restore());
+    break;
+  case parseLineScenario:
+    for (const char **line = lines; *line != NULL; ++line)
+    {
+      args.parseLine(*line);
+    }
+    break;
+  case parseCommandStringScenario:
+    args.parseCommandString(command, strlen(command));
+    break;
+  case responseFileScenario:
+    args.parseArgs(responseLine.argc(), responseLine.restore());
+    break;
+  case environmentScenario:
+    args.parseEnvironment("ZEROALLOC");
+    break;
+  case setScenario:
+    args.set("verbose", true);
+    args.set("level", 5);
+    args.set("threads", 4u);
+    args.set("ratio", 0.75);
+    args.set("name", "set name");
+    args.set("path", "/var/tmp");
+    break;
+  case scenarios:
+    break;
+  }
+}
+
+int main()
+{
+  if (!allocCountingEnabled())
+  {
+    printf("zeroalloc: allocations can't be counted in this build, skipped\n");
+    return 77;
+  }
+
+  char responseFile[] = "/tmp/argumentparser-zeroalloc-XXXXXX";
+  int fd = mkstemp(responseFile);
+  if (fd < 0)
+  {
+    fprintf(stderr, "zeroalloc: can't create a response file\n");
+    return 1;
+  }
+  std::string contents = std::string(command) + "\n";
+  if (write(fd, contents.data(), contents.size()) != (ssize_t) contents.size())
+  {
+    fprintf(stderr, "zeroalloc: can't write the response file\n");
+    close(fd);
+    unlink(responseFile);
+    return 1;
+  }
+  close(fd);
+
+  std::string responseArgument = std::string("@") + responseFile;
+  const char *responseWords[] = { "zeroalloc", responseArgument.c_str(),
+    "--quiet", NULL };
+
+  setenv("ZEROALLOC_LEVEL", "7", 1);
+  setenv("ZEROALLOC_NAME", "environment name", 1);
+  setenv("ZEROALLOC_UNKNOWN", "ignored", 1);
+
+  CommandLine commandLine(argvWords);
+  CommandLine responseLine(responseWords);
+
+  bool failed = false;
+  for (int scenario = 0; scenario < scenarios; ++scenario)
+  {
+    Targets targets;
+    ArgumentParser args("zeroalloc");
+    registerOptions(args, targets);
+    args.setBatchMode(scenario == parseArgsBatchScenario);
+
+    for (unsigned int i = 0; i < warmups; ++i)
+    {
+      run(Scenario(scenario), args, commandLine, responseLine);
+    }
+
+    AllocStats before = allocStats();
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+      run(Scenario(scenario), args, commandLine, responseLine);
+    }
+    AllocStats after = allocStats();
+
+    size_t count = after.count - before.count;
+    printf("%-20s %8lu allocations, %10lu bytes in %u parses\n",
+      scenarioNames[scenario], (unsigned long) count,
+      (unsigned long) (after.bytes - before.bytes), iterations);
+
+    if (count != 0 || targets.callbacks == 0)
+    {
+      failed = true;
+    }
+  }
+
+  unlink(responseFile);
+
+  if (failed)
+  {
+    fprintf(stderr, "zeroalloc: FAILED, a warmed-up parser allocated memory\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -8,6 +8,12 @@
 #ifndef ARGUMENT_H_
 #define ARGUMENT_H_
 
+#include <cstddef>
+
+/*
+ * value cell: a tag and a payload of 16 bytes, without a vtable. Values and
+ * defaults are stored in arrays of them.
+ */
 class Argument
 {
 public:
@@ -27,13 +33,19 @@ private:
   };
 
   bool defined;
-  ValueType valueType;
+  bool ownsString;
+  unsigned char valueType; // a ValueType, a byte keeps the cell at 16 bytes
 
   Argument();
 
 public:
   Argument(ValueType type);
-  virtual ~Argument();
+  Argument(const Argument &other);
+  // takes over an owned string, so it doesn't move when vectors grow
+  Argument(Argument &&other) noexcept;
+  ~Argument();
+
+  Argument &operator=(const Argument &other);
 
   void clear();
 
@@ -42,9 +54,11 @@ public:
   void set(unsigned int value);
   void set(double value);
   void set(const char *value);
+  // like set(const char *), but a string is referenced instead of copied
+  void borrow(const char *value);
 
   void setType(ValueType _wantedType);
-  ValueType getType();
+  ValueType getType() const;
   bool hasType(ValueType type) const;
 
   bool wasSet() const;
@@ -54,5 +68,8 @@ public:
   unsigned int getUInt() const;
   double getDouble() const;
   const char *getString() const;
+
+  // heap memory of an owned string
+  size_t memoryUsage() const;
 };
 #endif /* ARGUMENT_H_ */
@@ -8,24 +8,499 @@
 #ifndef ARGUMENTPARSER_H_
 #define ARGUMENTPARSER_H_
 
+#include <atomic>
 #include <cstddef>
+#include <new>
+#include <type_traits>
 
 class ArgumentParserInternals;
+class Schema;
+struct ConfigViewData;
+struct ConfigPublisherData;
+struct ArgumentValue;
+class ArgumentParser;
+
+/*
+ * immutable set of registered options (keys, types, defaults, comments, short
+ * keys, targets and callbacks), shared between parsers. Copying only copies a
+ * reference. See ArgumentParser::getSchema().
+ */
+class ArgumentSchema
+{
+private:
+  Schema *schema;
+
+  ArgumentSchema(Schema *_schema);
+
+  friend class ArgumentParser;
+
+public:
+  ArgumentSchema(const ArgumentSchema &other);
+  ~ArgumentSchema();
+
+  ArgumentSchema &operator=(const ArgumentSchema &other);
+};
+
+/*
+ * immutable copy of all values and standalones, taken by
+ * ArgumentParser::snapshot(). Values include defaults. It doesn't change when
+ * the parser continues parsing, and copying only copies a reference.
+ *
+ * All functions are const, noexcept and don't allocate memory, so any number
+ * of threads can read the same view without locking. Unknown keys and type
+ * mismatches silently return false, 0 or NULL.
+ */
+class ConfigView
+{
+private:
+  ConfigViewData *data;
+
+  ConfigView(ConfigViewData *_data);
+
+  friend class ArgumentParser;
+
+public:
+  ConfigView(const ConfigView &other) noexcept;
+  ~ConfigView();
+
+  ConfigView &operator=(const ConfigView &other) noexcept;
+
+  bool keyExists(const char *longKey) const noexcept;
+  bool wasValueSet(const char *longKey) const noexcept;
+
+  bool getBool(const char *longKey) const noexcept;
+  int getInt(const char *longKey) const noexcept;
+  unsigned int getUInt(const char *longKey) const noexcept;
+  double getDouble(const char *longKey) const noexcept;
+  const char *getCString(const char *longKey) const noexcept;
+
+  size_t getStandaloneCount() const noexcept;
+  const char *getCStandalone(size_t index) const noexcept;
+};
+
+/*
+ * the keys of a section of dotted keys and of all its subsections, sorted by
+ * key: section "net" holds net.http.port and net.timeout. Returned by
+ * ArgumentParser::getSection() with a single lookup, iterating doesn't
+ * compare any strings:
+ *
+ *   ArgumentSection net = args.getSection("net");
+ *   for (const ArgumentSection::Key *key = net.begin(); key != net.end();
+ *     ++key)
+ *     use(net.getName(*key), key->id); // "http.port", ...
+ *
+ * The keys point into the key index of the parser and are valid until the
+ * next option is registered on it.
+ */
+class ArgumentSection
+{
+public:
+  struct Key
+  {
+    const char *longKey; // the whole dotted key
+    int id; // see ArgumentParser::getId()
+  };
+
+private:
+  const Key *keys;
+  size_t count;
+  size_t prefixLength; // of "section.", 0 for all keys
+
+  ArgumentSection(const Key *_keys, size_t _count, size_t _prefixLength);
+
+  friend class ArgumentParser;
+
+public:
+  // an empty section
+  ArgumentSection();
+
+  size_t size() const;
+  bool empty() const;
+  const Key *begin() const;
+  const Key *end() const;
+  const Key &operator[](size_t index) const;
+
+  // the key without the section: "http.port" of net.http.port in "net"
+  const char *getName(const Key &key) const;
+};
+
+/*
+ * publishes configurations to concurrent readers, RCU style. A reload parses
+ * into a parser of its own and publishes a snapshot of it, which replaces the
+ * current view with a single atomic pointer store. Readers see either the old
+ * or the new view, never a mix:
+ *
+ *   ConfigPublisher::Guard config(publisher);
+ *   unsigned int threads = config->getUInt("threads");
+ *
+ * A Guard pins the current view without locking or reference counting.
+ * Replaced views are deleted once no Guard can see them anymore, so Guards
+ * should be short-lived.
+ */
+class ConfigPublisher
+{
+private:
+  ConfigPublisherData *data;
+
+  ConfigPublisher(const ConfigPublisher &other);
+  ConfigPublisher &operator=(const ConfigPublisher &other);
+
+public:
+  class Guard
+  {
+  private:
+    ConfigPublisherData *data;
+    unsigned int slot;
+    const ConfigView *view;
+
+    Guard(const Guard &other);
+    Guard &operator=(const Guard &other);
+
+  public:
+    Guard(const ConfigPublisher &publisher);
+    ~Guard();
+
+    const ConfigView &operator*() const;
+    const ConfigView *operator->() const;
+  };
+
+  ConfigPublisher(const ConfigView &initial);
+  // there must not be any Guards left
+  ~ConfigPublisher();
+
+  void publish(const ConfigView &view);
+  void publish(ArgumentParser &parser);
+
+  // a reference to the current view, for readers that keep it for longer
+  ConfigView get() const;
+  // deletes replaced views that aren't visible anymore. publish() does this
+  // as well.
+  void reclaim();
+};
+
+/*
+ * statistics of a parser, returned by ArgumentParser::getStats(). They're
+ * only collected if the library was configured with --enable-stats (which
+ * defines ARGUMENTPARSER_STATS). Otherwise, enabled is false and everything
+ * else is 0.
+ *
+ * Allocations only cover the memory allocated explicitly by the parser:
+ * copies of keys, comments and strings, string arena blocks and snapshots.
+ * Times are in nanoseconds of the monotonic clock. Tokenizing doesn't include
+ * the conversions and callbacks of the parsed values.
+ */
+struct ParseStats
+{
+  bool enabled;
+
+  unsigned long lookups; // key index lookups
+  unsigned long comparisons; // strcmp() calls of key lookups
+  unsigned long allocations;
+  unsigned long allocatedBytes;
+  unsigned long boolConversions; // string values converted, by type
+  unsigned long intConversions;
+  unsigned long uintConversions;
+  unsigned long doubleConversions;
+  unsigned long stringConversions;
+  unsigned long targetsWritten;
+  unsigned long callbacksFired;
+  unsigned long linesParsed;
+  unsigned int maxIncludeDepth; // nested files and response files
+
+  unsigned long long registrationTime;
+  unsigned long long tokenizingTime;
+  unsigned long long conversionTime;
+  unsigned long long callbackTime;
+};
+
+/*
+ * memory held by a parser and its schema in bytes, returned by
+ * ArgumentParser::memoryUsage(). Containers count with their capacity, the
+ * nodes of the key index are estimated and allocator overhead isn't
+ * included. A shared schema is counted by every parser that uses it.
+ */
+struct MemoryUsage
+{
+  size_t options; // option records with their default cells and links
+  size_t keyIndex; // lookup of long keys
+  size_t strings; // keys, owned comments and defaults, file names
+  size_t values; // value cells of all layers, value table and bitsets
+  size_t buffers; // string values, standalones and command strings
+  size_t total;
+};
 
 class ArgumentParser
 {
 public:
   typedef void (*Callback)(void*);
+  // registers the options of a sub-command, see addSubcommand()
+  typedef void (*SubcommandInit)(ArgumentParser &args, void *data);
+
+  /*
+   * sources of values, in order of precedence: a value of a higher layer
+   * overrides the ones of all lower layers, no matter in which order they
+   * were parsed. Every layer keeps its values, so a layer can be cleared and
+   * reparsed without touching the others.
+   */
+  enum Layer
+  {
+    defaultLayer, // registered defaults
+    systemLayer, // e.g. /etc
+    userLayer, // e.g. $HOME, the default of parseFile() and parseLine()
+    environmentLayer,
+    argvLayer, // parseArgs() and parseCommandString()
+    runtimeLayer // set()
+  };
+
+  /*
+   * how parseEnvironment() maps variable names to keys. Keys have no
+   * underscores, so '_' or '__' after the prefix maps to the '.' of a dotted
+   * key: PROG_SERVER_PORT and PROG_SERVER__PORT both set server.port.
+   */
+  enum KeyCase
+  {
+    exactCase, lowerCase
+  };
+
+  /*
+   * passed to event callbacks, see registerCallback(). Describes the value
+   * that was set and where it came from. Pointers are only valid during the
+   * callback.
+   */
+  struct Event
+  {
+    enum Type
+    {
+      noType, boolType, intType, uintType, doubleType, stringType
+    };
+
+    unsigned int id; // option id, in order of registration. -1: standalones
+    const char *longKey; // NULL for standalones
+    Type type; // noType for file options, stringType for standalones
+    union
+    {
+      bool boolValue;
+      int intValue;
+      unsigned int uintValue;
+      double doubleValue;
+      const char *stringValue; // the latest standalone, for standalones
+    } value;
+
+    // source: argv index, or index of the word of a command string. -1 if the
+    // value wasn't parsed from a command line
+    int argIndex;
+    // config or response file, NULL otherwise. argIndex is the index of the
+    // argument that included the file, if any. The parser stores each file
+    // name once, so this one stays valid as long as the parser
+    const char *file;
+    unsigned int line; // line in file, 0 if unknown
+
+    void *data; // as passed to registerCallback()
+  };
+
+  // maps the type of a struct field to the type of its option
+  template<typename Type>
+  struct FieldType;
+
+  /*
+   * a field of a struct that is bound to an option, see bindStruct(). Fill
+   * it in with ARGUMENTPARSER_FIELD, which derives type and offset from the
+   * member. Fields are registered like other options: keys are copied, and
+   * so are comments unless setStaticStrings(true) is on. The array of fields
+   * only needs to be valid during bindStruct().
+   */
+  struct Field
+  {
+    const char *longKey;
+    Event::Type type;
+    size_t offset;
+    size_t size; // of the field, the capacity of strings
+    const char *comment;
+    unsigned char shortKey;
+  };
+
+  // fields of other types than bool, int, unsigned int, double and char[]
+  // don't compile
+  template<typename Struct, typename Type>
+  static Field field(const char *longKey, Type Struct::*, size_t offset,
+    const char *comment = NULL, unsigned char shortKey = '\0')
+  {
+    Field result = { longKey, FieldType<Type>::type, offset, sizeof(Type),
+      comment, shortKey };
+    return result;
+  }
+
+  /*
+   * callback for Events: a function pointer or a small function object, e.g.
+   * a lambda that captures up to three pointers. It's stored in place, without
+   * heap allocation, so bigger or non-trivially copyable function objects
+   * don't compile. Capture a pointer to them instead.
+   */
+  class EventCallback
+  {
+  private:
+    static const size_t bufferSize = 3 * sizeof(void*);
+
+    typedef void (*Invoke)(const void *function, const Event &event);
+
+    alignas(std::max_align_t) unsigned char buffer[bufferSize];
+    Invoke invoke;
+
+    template<typename Function>
+    static void call(const void *function, const Event &event)
+    {
+      (*static_cast<const Function*>(function))(event);
+    }
+
+  public:
+    template<typename Function>
+    EventCallback(Function function) :
+      invoke(&call<Function>)
+    {
+      static_assert(sizeof(Function) <= bufferSize,
+        "callback too big, capture a pointer instead");
+      static_assert(alignof(Function) <= alignof(std::max_align_t),
+        "callback alignment not supported");
+      static_assert(std::is_trivially_copyable<Function>::value,
+        "callback must be trivially copyable, capture a pointer instead");
+
+      new (buffer) Function(function);
+    }
+
+    void operator()(const Event &event) const
+    {
+      invoke(buffer, event);
+    }
+  };
+
+  /*
+   * read-only view of all standalones. Standalones are stored back to back
+   * in a single buffer, so the view and all pointers taken from it are only
+   * valid until the next standalone is added.
+   */
+  class StandaloneList
+  {
+  public:
+    class iterator
+    {
+    private:
+      const char *data;
+      const size_t *offset;
+
+    public:
+      iterator(const char *_data, const size_t *_offset) :
+        data(_data), offset(_offset)
+      {
+      }
+
+      const char *operator*() const
+      {
+        return data + *offset;
+      }
+
+      iterator &operator++()
+      {
+        ++offset;
+        return *this;
+      }
+
+      bool operator==(const iterator &other) const
+      {
+        return offset == other.offset;
+      }
+
+      bool operator!=(const iterator &other) const
+      {
+        return offset != other.offset;
+      }
+    };
+
+  private:
+    const char *data;
+    const size_t *offsets;
+    size_t count;
+
+  public:
+    StandaloneList(const char *_data, const size_t *_offsets, size_t _count) :
+      data(_data), offsets(_offsets), count(_count)
+    {
+    }
+
+    iterator begin() const
+    {
+      return iterator(data, offsets);
+    }
+
+    iterator end() const
+    {
+      return iterator(data, offsets + count);
+    }
+
+    size_t size() const
+    {
+      return count;
+    }
+
+    const char *operator[](size_t index) const
+    {
+      return data + offsets[index];
+    }
+  };
 
 private:
   ArgumentParserInternals *args;
 
+  // see clone()
+  explicit ArgumentParser(ArgumentParserInternals *_args);
+
 public:
   ArgumentParser(const char *progname = "");
+  /*
+   * creates a parser for the options of a schema, without registering
+   * anything. Targets and callbacks of the schema are shared as well, so
+   * parsers that run concurrently should use the get functions instead.
+   */
+  ArgumentParser(const ArgumentSchema &schema, const char *progname = "");
   virtual ~ArgumentParser();
 
   /*
-   * longKey: long key as used in CLI (--longKey) and in files (longKey = ...)
+   * returns the options registered so far. Registering further options on
+   * this parser afterwards doesn't change the returned schema, but copies it.
+   */
+  ArgumentSchema getSchema();
+
+  /*
+   * forgets all values and standalones, so the parser can parse the next
+   * command line. All memory is kept for reuse.
+   *
+   * Once a parser has parsed similar input a few times, parseArgs(),
+   * parseLine(), parseCommandString(), parseEnvironment(), response files
+   * and set() don't allocate memory anymore as long as reset() is called
+   * between the parses. parseFile(), snapshot() and registration still
+   * allocate.
+   */
+  void reset();
+
+  // freezes the current values for concurrent readers. See ConfigView.
+  ConfigView snapshot();
+
+  /*
+   * returns a new parser with the options and values of this one, to be
+   * deleted by the caller. Nothing is copied: both parsers share the schema
+   * and the current values, and each one copies only the values it changes
+   * afterwards, so a clone costs O(changed keys) instead of O(all keys).
+   * reset() drops the shared values and allocates all cells again.
+   *
+   * Targets and callbacks of the schema are shared as well, like with
+   * ArgumentParser(const ArgumentSchema&). The clone runs its callbacks
+   * synchronously. Cloning isn't thread-safe, but clones can be used by
+   * different threads.
+   */
+  ArgumentParser *clone();
+
+  /*
+   * longKey: long key as used in CLI (--longKey) and in files (longKey = ...).
+   * Alphanumeric, dots separate sections (net.timeout, see getSection())
    * shortKey: short key as used in CLI (-k). One char only, '\0': leave blank
    * target: if defined, write value directly to (*target). This eliminates
    * the need to call the get functions
@@ -59,23 +534,131 @@ public:
 
   void registerCallback(const char *longKey, Callback callback, void* data =
   NULL);
+  /*
+   * typed callback, which receives the value and its source:
+   *
+   *   args.registerCallback("threads", [](const ArgumentParser::Event &event)
+   *   {
+   *     pool.resize(event.value.uintValue);
+   *   });
+   *
+   * All callbacks of a key fire in order of registration. A NULL key
+   * registers a standalone callback.
+   */
+  void registerCallback(const char *longKey, const EventCallback &callback,
+    void *data = NULL);
+  /*
+   * async callbacks of 'after' only start once all earlier async callbacks
+   * of 'before' have finished. Contradicting orders are rejected.
+   */
+  void registerCallbackOrder(const char *before, const char *after);
 
   void Standalones(int maximum = -1, const char *helpKey = "argument",
     const char *comment = NULL);
 
+  /*
+   * sub-commands: 'prog [options] name [options]'. init registers the
+   * options of the sub-command, but only once its name is parsed as the
+   * first standalone, so unused sub-commands cost nothing. Global options
+   * stay valid after the name, and --help lists the options of the selected
+   * sub-command separately. A parser selects at most one sub-command.
+   */
+  void addSubcommand(const char *name, SubcommandInit init, void *data = NULL,
+    const char *comment = NULL);
+  // name of the selected sub-command, NULL if there is none
+  const char *getSubcommand();
+
   // if one of the keys are encountered, a file is included (read in place)
   void File(const char *longKey, const char *comment = NULL,
     unsigned char shortKey = '\0');
 
+  /*
+   * binds the fields of a struct to options in one call. Every field
+   * becomes an option whose default is the current value of the field and
+   * whose target is the field itself, so parsed values are written straight
+   * into the struct:
+   *
+   *   struct Config { unsigned int threads; char name[64]; } config = ...;
+   *   static const ArgumentParser::Field fields[] = {
+   *     ARGUMENTPARSER_FIELD(Config, threads, "number of threads", 't'),
+   *     ARGUMENTPARSER_FIELD(Config, name, "a name") };
+   *   args.bindStruct(config, fields);
+   *
+   * Strings are truncated to the size of their char array. The struct must
+   * outlive the parser, or at least its parses.
+   */
+  void bindStruct(void *base, const Field *fields, size_t count);
+  template<typename Struct, size_t count>
+  void bindStruct(Struct &object, const Field (&fields)[count])
+  {
+    bindStruct(&object, fields, count);
+  }
+  // writes the fields of a bound struct like writeFile() writes values
+  bool writeStruct(const char *filename, const void *base);
+
+  /*
+   * static: if true, comments and string default values of the options that
+   * are registered afterwards are kept by pointer instead of being copied.
+   * They must stay valid as long as the parser and its schema exist, like
+   * string literals do. Saves memory and allocations when there are
+   * thousands of documented options. The default is false.
+   */
+  void setStaticStrings(bool isStatic);
+
   void registerShortKey(unsigned char shortKey, const char *longKey);
   void registerComment(const char *longKey, const char *comment);
   void registerTarget(const char *longKey, void *target);
+  /*
+   * atomic targets, for values that are changed while other threads read
+   * them. Values are stored with the given order, which may be
+   * std::memory_order_relaxed, _release or _seq_cst. The atomic must match
+   * the type of the option.
+   */
+  void registerTarget(const char *longKey, std::atomic<bool> *target,
+    std::memory_order order = std::memory_order_release);
+  void registerTarget(const char *longKey, std::atomic<int> *target,
+    std::memory_order order = std::memory_order_release);
+  void registerTarget(const char *longKey, std::atomic<unsigned int> *target,
+    std::memory_order order = std::memory_order_release);
+  void registerTarget(const char *longKey, std::atomic<double> *target,
+    std::memory_order order = std::memory_order_release);
 
   bool keyExists(const char *longKey);
+  /*
+   * fast path, see ArgumentParserFast.h: the id of an option, -1 if the key
+   * is unknown, and the address of the table of current values, which is
+   * indexed by id. Index -1 holds an unset value.
+   */
+  int getId(const char *longKey);
+  const ArgumentValue * const *getValueTable();
+  /*
+   * the keys of a section of dotted keys and its subsections, sorted, see
+   * ArgumentSection. "" returns all keys, unknown sections are empty.
+   */
+  ArgumentSection getSection(const char *section);
   bool wasValueSet(const char *longKey, bool includeDefault = false);
+  // top-most layer with a value, defaultLayer if there is none
+  Layer getLayer(const char *longKey);
+  /*
+   * forgets all values of a layer and frees the memory of its strings. Keys
+   * whose value changed get their targets and callbacks updated, like after
+   * a parse. To replace a layer, e.g. on reload, clear and reparse it inside
+   * beginBatch()/commitBatch().
+   */
+  void clearLayer(Layer layer);
   bool shortKeyExists(unsigned char shortKey);
   void getLongKey(unsigned char shortKey, char *output);
+  // true if every option without a default has a value
   bool allValuesSet(const char *errorFormat = NULL);
+  /*
+   * constraints between options: once longKey has a value, requiredKey needs
+   * a value or default as well, and conflictingKey must not have a value.
+   * checkConstraints() checks them after parsing and prints every violation
+   * if verbose.
+   */
+  void registerRequirement(const char *longKey, const char *requiredKey);
+  void registerConflict(const char *longKey, const char *conflictingKey);
+  bool checkConstraints(bool verbose = true);
 
   bool getBool(const char *longKey);
   int getInt(const char *longKey);
@@ -84,9 +667,14 @@ public:
   void getString(const char *longKey, char *output);
   const char *getCString(const char *longKey);
 
+  // pointers returned by getCStandalone() are valid until the next
+  // standalone is added. See StandaloneList.
   int getStandaloneCount();
   void getStandalone(unsigned int index, char *output);
   const char *getCStandalone(unsigned int index);
+  StandaloneList getStandalones();
+  // preallocate room for count standalones with a total length of bytes
+  void reserveStandalones(size_t count, size_t bytes = 0);
 
   void set(const char *longKey, bool value);
   void set(const char *longKey, int value);
@@ -96,13 +684,130 @@ public:
 
   void setProgName(const char *progname);
 
-  void parseFile(const char *filename);
-  void parseLine(const char *line);
+  /*
+   * batch: if true, parseArgs(), parseFile() and parseLine() only write the
+   * values while parsing. Targets and callbacks of every key that was set are
+   * committed once at the end of the parse, in order of registration, and the
+   * standalone callback fires at most once. The default is immediate mode, in
+   * which every set() writes the targets and fires the callbacks.
+   *
+   * beginBatch() and commitBatch() open and close such a transaction
+   * manually, e.g. around several set() calls. They may be nested.
+   */
+  void setBatchMode(bool batch);
+  void beginBatch();
+  void commitBatch();
+
+  /*
+   * threads > 0: callbacks run asynchronously on a work-stealing pool of that
+   * many threads. They're queued while parsing and start when the outermost
+   * parse or batch is done. Callbacks of the same key run in order, keys
+   * ordered by registerCallbackOrder() wait for each other, all others run
+   * concurrently. Async callbacks must not use the parser; the Event holds
+   * everything they need, its strings stay valid until reset().
+   *
+   * waitAtEnd: every parse blocks until its callbacks have finished.
+   * Otherwise, waitForCallbacks() and callbacksDone() are the completion
+   * handle. reset() and the destructor always wait. threads 0 (the default)
+   * runs callbacks synchronously again.
+   */
+  void setAsyncCallbacks(unsigned int threads, bool waitAtEnd = true);
+  void waitForCallbacks();
+  bool callbacksDone();
+
+  void parseFile(const char *filename, Layer layer = userLayer);
+  /*
+   * reads and splits all files in parallel, then applies them in the given
+   * order, so later files override earlier ones like consecutive parseFile()
+   * calls do. Included files are parsed when their include key is applied.
+   */
+  void parseFiles(const char * const *filenames, size_t count,
+    Layer layer = userLayer);
+  void parseLine(const char *line, Layer layer = userLayer);
   void parseArgs(int argc, char **argv);
+  /*
+   * splits a command string into words like a shell would (single and double
+   * quotes, backslash escapes) and parses them like parseArgs() does. The
+   * string only contains arguments, no program name. It is copied into a
+   * buffer that is reused by the next call, so no memory is allocated per word.
+   */
+  void parseCommandString(const char *command, size_t length);
+  /*
+   * reads all environment variables PREFIX_KEY in a single pass over environ
+   * into the environment layer. lowerCase maps MYPROG_THREADS to the key
+   * 'threads', exactCase uses the name as it is. KeyCase describes how
+   * dotted keys are named. Variables without a matching key are ignored. A
+   * NULL or empty prefix matches every variable.
+   */
+  void parseEnvironment(const char *prefix, KeyCase keyCase = lowerCase);
 
   bool writeFile(const char *filename); // false on success, true on failure
 
+  /*
+   * shell completion: 'prog --complete words...' prints the candidates for
+   * the last word, one per line: long and short keys, true/false for bool
+   * values and sub-command names. writeCompletionIndex() saves a compact
+   * index of all registered keys, e.g. at install time (false on success).
+   * complete() answers from that index and exits, so calling it first thing
+   * in main() skips registration and all user code:
+   *
+   *   ArgumentParser::complete(argc, argv, "/usr/share/prog/completion");
+   *
+   * It returns false if argv isn't a completion query or the index can't be
+   * read. parseArgs() answers queries from the registered keys instead,
+   * unless there is an option 'complete'. Options of sub-commands aren't
+   * indexed.
+   */
+  bool writeCompletionIndex(const char *filename);
+  static bool complete(int argc, char **argv, const char *indexFile);
+
   void displayHelpMessage();
+
+  MemoryUsage memoryUsage();
+
+  // counters and timings since construction or resetStats(). See ParseStats.
+  ParseStats getStats();
+  void resetStats();
+};
+
+template<>
+struct ArgumentParser::FieldType<bool>
+{
+  static const Event::Type type = Event::boolType;
+};
+
+template<>
+struct ArgumentParser::FieldType<int>
+{
+  static const Event::Type type = Event::intType;
+};
+
+template<>
+struct ArgumentParser::FieldType<unsigned int>
+{
+  static const Event::Type type = Event::uintType;
+};
+
+template<>
+struct ArgumentParser::FieldType<double>
+{
+  static const Event::Type type = Event::doubleType;
+};
+
+template<size_t size>
+struct ArgumentParser::FieldType<char[size]>
+{
+  static const Event::Type type = Event::stringType;
 };
 
+// field of a struct for ArgumentParser::bindStruct(), keyed by the member
+// name: ARGUMENTPARSER_FIELD(Struct, member, comment [, shortKey])
+#define ARGUMENTPARSER_FIELD(Struct, member, ...) \
+  ArgumentParser::field(#member, &Struct::member, offsetof(Struct, member), \
+    __VA_ARGS__)
+// the same with a key of its own, for members that aren't valid keys
+#define ARGUMENTPARSER_NAMED_FIELD(Struct, member, longKey, ...) \
+  ArgumentParser::field(longKey, &Struct::member, offsetof(Struct, member), \
+    __VA_ARGS__)
+
 #endif /* ARGUMENTPARSER_H_ */
@@ -0,0 +1,139 @@
+/*
+ * ArgumentParserFast.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef ARGUMENTPARSERFAST_H_
+#define ARGUMENTPARSERFAST_H_
+
+#include <ArgumentParser.h>
+#include <cstddef>
+
+/*
+ * current value of an option, as returned by the get functions: the value of
+ * the top-most layer, or the default. The parser keeps one per option in a
+ * table that inline code can read directly. The layout is part of the ABI:
+ *
+ *   offset  0  value, 8 bytes
+ *   offset  8  type, an ArgumentParser::Event::Type
+ *   offset  9  layer of the value, defaultLayer for defaults and unset values
+ *   offset 10  isSet, 1 if there is a value or a default
+ *   size    16
+ *
+ * Unset values are all zero. Strings are valid until the value changes or
+ * the parser is reset.
+ */
+struct ArgumentValue
+{
+  union
+  {
+    bool boolValue;
+    int intValue;
+    unsigned int uintValue;
+    double doubleValue;
+    const char *stringValue;
+  } value;
+  unsigned char type;
+  unsigned char layer;
+  unsigned char isSet;
+  unsigned char reserved[5];
+};
+
+static_assert(sizeof(ArgumentValue) == 16, "ArgumentValue layout changed");
+static_assert(offsetof(ArgumentValue, type) == 8,
+  "ArgumentValue layout changed");
+static_assert(offsetof(ArgumentValue, layer) == 9,
+  "ArgumentValue layout changed");
+static_assert(offsetof(ArgumentValue, isSet) == 10,
+  "ArgumentValue layout changed");
+
+/*
+ * inline getters for hot code, without the call into the library that every
+ * ArgumentParser function costs. Keys are looked up once:
+ *
+ *   ArgumentParserFast fast(args);
+ *   ArgumentParserFast::Handle threads = fast.handle("threads");
+ *   for (...)
+ *     use(fast.getUInt(threads)); // a load from the value table
+ *
+ * The getter has to match the type of the option, nothing is checked or
+ * converted. Handles of unknown keys read an unset value: false, 0 or NULL.
+ * Values are updated by every parse, set(), clearLayer() and reset(), so
+ * reading them while another thread uses the parser is a data race.
+ */
+class ArgumentParserFast
+{
+public:
+  struct Handle
+  {
+    int id; // -1 for unknown keys
+  };
+
+private:
+  ArgumentParser *parser;
+  const ArgumentValue * const *table;
+
+public:
+  explicit ArgumentParserFast(ArgumentParser &_parser) :
+    parser(&_parser), table(_parser.getValueTable())
+  {
+  }
+
+  Handle handle(const char *longKey) const
+  {
+    Handle handle = { parser->getId(longKey) };
+    return handle;
+  }
+
+  // without a lookup, for the keys of an ArgumentSection
+  Handle handle(const ArgumentSection::Key &key) const
+  {
+    Handle handle = { key.id };
+    return handle;
+  }
+
+  // the table itself, indexed by id. Valid until the next registration
+  const ArgumentValue *values() const
+  {
+    return *table;
+  }
+
+  const ArgumentValue &operator[](Handle handle) const
+  {
+    return (*table)[handle.id];
+  }
+
+  bool wasValueSet(Handle handle) const
+  {
+    return (*table)[handle.id].layer != ArgumentParser::defaultLayer;
+  }
+
+  bool getBool(Handle handle) const
+  {
+    return (*table)[handle.id].value.boolValue;
+  }
+
+  int getInt(Handle handle) const
+  {
+    return (*table)[handle.id].value.intValue;
+  }
+
+  unsigned int getUInt(Handle handle) const
+  {
+    return (*table)[handle.id].value.uintValue;
+  }
+
+  double getDouble(Handle handle) const
+  {
+    return (*table)[handle.id].value.doubleValue;
+  }
+
+  const char *getCString(Handle handle) const
+  {
+    return (*table)[handle.id].value.stringValue;
+  }
+};
+
+#endif /* ARGUMENTPARSERFAST_H_ */
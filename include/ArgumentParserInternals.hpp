@@ -8,84 +8,206 @@
 #ifndef ARGUMENTPARSERINTERNALS_H_
 #define ARGUMENTPARSERINTERNALS_H_
 
-#include <map>
 #include <Argument.hpp>
+#include <ArgumentParserFast.h>
+#include <Bitset.hpp>
+#include <CallbackScheduler.hpp>
+#include <ConfigViewData.hpp>
+#include <Schema.hpp>
+#include <Stats.hpp>
+#include <StringArena.hpp>
+#include <ValueSet.hpp>
+#include <tokenize.hpp>
 #include <cstring>
+#include <set>
 #include <vector>
 
+class ConfigFile;
+
 class ArgumentParserInternals
 {
 public:
-  typedef void (*Callback)(void*);
+  typedef Schema::Callback Callback;
+  typedef Schema::EventCallback EventCallback;
+  typedef ArgumentParser::Layer Layer;
+  typedef ArgumentParser::SubcommandInit SubcommandInit;
 
 private:
-  struct cmp_str
+  static const unsigned int noId = Schema::noId;
+
+  typedef std::vector<char> CommandBuffer;
+
+  Schema *schema;
+  ValueSet values;
+  char *progname;
+  CommandBuffer commandBuffer; // reused by parseCommandString()
+  // last [section] of parseLine(), '\0'-terminated. Empty outside of sections
+  std::vector<char> lineSection;
+
+  // where the value that is being set comes from, see ArgumentParser::Event
+  struct Source
   {
-    bool operator()(const char *a, const char* b)
-    {
-      return std::strcmp(a, b) < 0;
-    }
+    int argIndex;
+    const char *file; // from fileNames, valid as long as the parser
+    unsigned int line;
+
+    Source();
   };
 
-  struct CallbackContainer
+  Source source;
+  Source keySource; // source of a long key that waits for its value
+
+  // names of the files that were parsed, each stored once
+  typedef std::set<const char*, Schema::cmp_str> FileNameSet;
+  FileNameSet fileNames;
+  StringArena fileNameStrings;
+
+  // current values for ArgumentParserFast, kept in sync by commitKey().
+  // valueTable[0] is the unset value of unknown ids, valueCells[id] is
+  // valueTable[id + 1]
+  std::vector<ArgumentValue> valueTable;
+  ArgumentValue *valueCells;
+
+  // ids with a value, kept in sync by commitKey()
+  Bitset setKeys;
+  Bitset presentKeys; // scratch: values or defaults, see checkConstraints()
+
+  // batch commit: targets and callbacks of dirty keys are deferred
+  bool batchParsing;
+  unsigned int batchDepth;
+  Bitset dirtyKeys;
+  std::vector<Source> dirtySources; // indexed by id
+  bool dirtyStandalones;
+  Source standaloneSource;
+
+  // only collected with ARGUMENTPARSER_STATS
+  ParseStats stats;
+  unsigned int includeDepth; // files and response files being parsed
+
+  // comments and string defaults are borrowed instead of copied
+  bool staticStrings;
+
+  // async callbacks: queued while parsing, released when the outermost
+  // parse or batch is done. NULL: callbacks run synchronously
+  CallbackScheduler *scheduler;
+  bool waitForCallbacksAtEnd;
+  unsigned int callbackDepth;
+
+  // layer that parsing and set() write to, see ArgumentParser::Layer
+  Layer layer;
+  Bitset changedKeys; // scratch for clearLayer()
+
+  // sub-commands register their options once they're selected
+  struct Subcommand
   {
-    Callback callback;
+    char *name;
+    char *comment;
+    SubcommandInit init;
     void *data;
+    ArgumentParser *parser; // passed to init
+  };
+  typedef std::vector<Subcommand> SubcommandVector;
+
+  SubcommandVector subcommands;
+  unsigned int subcommand; // index of the selected one, noId if none
+  unsigned int subcommandFirstId; // first option of the selected one
 
-    CallbackContainer(Callback _callback, void *_data);
+  // structs bound by bindStruct(), for writeStruct()
+  struct BoundField
+  {
+    unsigned int id;
+    ArgumentParser::Event::Type type;
+    size_t offset;
+  };
+  struct Binding
+  {
+    const char *base;
+    std::vector<BoundField> fields;
   };
+  typedef std::vector<Binding> BindingVector;
 
-  typedef std::map<const char *, Argument, cmp_str> ArgumentMap;
-  typedef std::multimap<const char *, void*, cmp_str> TargetMap;
-  typedef std::pair<TargetMap::iterator, TargetMap::iterator> TargetRange;
-  typedef std::map<const char *, const char *, cmp_str> CommentMap;
-  typedef std::vector<const char *> StandaloneVector;
-  typedef std::multimap<const char *, CallbackContainer, cmp_str> CallbackMap;
-  typedef std::pair<CallbackMap::iterator, CallbackMap::iterator> CallbackRange;
-
-  char **shortKeys;
-  ArgumentMap arguments;
-  ArgumentMap defaults;
-  TargetMap targets;
-  CommentMap comments;
-  StandaloneVector standalones;
-  CallbackMap callbacks;
-  int maxStandalones;
-  char *standaloneComment;
-  char *standaloneHelpKey;
-  char *progname;
+  BindingVector bindings;
 
-  void clearShortKeys();
-  void clearShortKey(unsigned char shortKey);
-  void clearArguments();
-  void clearTargets();
-  void clearDefaults();
-  void clearComments();
-  void clearStandalones();
-  void clearCallbacks();
-  void clearAll();
+  // the schema may only be changed while it isn't shared
+  Schema *writableSchema();
 
   void lookForHelp();
 
-  Argument
-  *registerArgument(const char *longKey, Argument::ValueType valueType);
+  unsigned int registerArgument(const char *longKey,
+    Argument::ValueType valueType);
+  unsigned int fetchId(const char *longKey);
+  Argument *fetchArgument(unsigned int id, bool useDefault);
   Argument *fetchArgument(const char *longKey, bool useDefault = false);
-  const char *fetchComment(const char *longKey);
-  Argument *registerDefault(const char *longKey, Argument::ValueType valueType);
-  Argument *fetchDefault(const char *longKey);
   void addStandalone(const char *standalone);
-  void fireCallbacks(const char *longKey);
+  // the stored copy of a file name, for Source::file
+  const char *storeFileName(const char *filename);
+  void initEvent(ArgumentParser::Event &event, const Source &source);
+  void fireCallbacks(unsigned int id, const Source &source);
+  void fireStandaloneCallbacks(const Source &source);
+  void beginCallbacks();
+  void endCallbacks();
 
   void setTarget(Argument *argument, void *target);
-  void setTargets(const char *longKey);
+  void setTarget(Argument *argument, const Schema::Target &target);
+  void setTargets(unsigned int id);
   void setAllTargets();
 
+  // grows the value table with the schema. updateAll: the defaults moved
+  void updateValueTable(bool updateAll);
+  void updateValueCell(unsigned int id);
+
+  // set targets and fire callbacks, or defer them while batching
+  void commitKey(unsigned int id);
+  void commitStandalones();
+
+  // response files (@file) may include each other up to this depth
+  static const unsigned int maxResponseFileDepth = 16;
+
+  enum ResponseFileResult
+  {
+    responseFileParsed, responseFileMissing, responseFileFailed
+  };
+
+  void parseArgv(int argc, char **argv);
+  // value NULL: the key is a bool switch
+  void setPendingKey(const char *key, const char *value);
+  // returns true if parsing has to be aborted
+  bool parseArgument(char *arg, const char *&lastKey, unsigned int depth);
+  ResponseFileResult parseResponseFile(const char *filename,
+    const char *&lastKey, unsigned int depth);
+
   const char *getLongKey(unsigned char shortKey);
 
+  // noId if name isn't a sub-command that can be selected now
+  unsigned int findSubcommand(const char *name);
+  bool isBoolKey(const char *longKey);
+  void selectSubcommand(unsigned int index);
+  bool printOption(unsigned int id);
+
+  // argv[1] is --complete
+  static bool isCompletionQuery(int argc, char **argv);
+  void buildCompletionIndex(std::vector<char> &buffer);
+
+  void applyFile(const ConfigFile &file, const char *filename);
+  void set(unsigned int id, const char *value);
+  void reportLine(LineType type, const char *line);
+
 public:
   ArgumentParserInternals(const char *_progname);
+  // shares the schema, which must not be changed anymore
+  ArgumentParserInternals(Schema *_schema, const char *_progname);
+  // shares schema and values with other, see ArgumentParser::clone()
+  ArgumentParserInternals(ArgumentParserInternals &other,
+    ArgumentParser *parser);
   virtual ~ArgumentParserInternals();
 
+  // returns a new reference to the schema
+  Schema *getSchema();
+  // forget all values and standalones, keeping the memory for reuse
+  void reset();
+  // copy all values into a new block with a single reference
+  ConfigViewData *snapshot();
+
   /*
    * longKey: long key as used in CLI (--longKey) and in files (longKey = ...)
    * shortKey: short key as used in CLI (-k). One char only, '\0': leave blank
@@ -120,21 +242,47 @@ public:
     const char *comment, unsigned char shortKey, char *target);
 
   void registerCallback(const char *longKey, Callback callback, void* data);
+  void registerCallback(const char *longKey, const EventCallback &callback,
+    void *data);
+  void registerCallbackOrder(const char *before, const char *after);
 
   void Standalones(int maximum, const char *helpKey, const char *comment);
 
+  void addSubcommand(ArgumentParser *parser, const char *name,
+    SubcommandInit init, void *data, const char *comment);
+  const char *getSubcommand();
+
   // if one of the keys are encountered, a file is included (read in place)
   void File(const char *longKey, const char *comment, unsigned char shortKey);
 
+  // fields become options with their value as default and themselves as
+  // target
+  void bindStruct(void *base, const ArgumentParser::Field *fields,
+    size_t count);
+  bool writeStruct(const char *filename, const void *base);
+
   void registerShortKey(unsigned char shortKey, const char *longKey);
+  void setStaticStrings(bool isStatic);
   void registerComment(const char *longKey, const char *comment);
   void registerTarget(const char *longKey, void *target);
+  // target points to a std::atomic<> of the type of the option
+  void registerAtomicTarget(const char *longKey, void *target,
+    Argument::ValueType type, std::memory_order order);
 
   bool keyExists(const char *longKey);
+  int getId(const char *longKey);
+  const ArgumentValue * const *getValueTable();
+  void getSection(const char *section, const ArgumentSection::Key *&keys,
+    size_t &count);
   bool wasValueSet(const char *longKey, bool includeDefault);
+  Layer getLayer(const char *longKey);
+  void clearLayer(Layer clearedLayer);
   bool shortKeyExists(unsigned char shortKey);
   void getLongKey(unsigned char shortKey, char *output);
   bool allValuesSet(const char *errorFormat);
+  void registerRequirement(const char *longKey, const char *requiredKey);
+  void registerConflict(const char *longKey, const char *conflictingKey);
+  bool checkConstraints(bool verbose);
 
   bool getBool(const char *longKey);
   int getInt(const char *longKey);
@@ -146,6 +294,8 @@ public:
   int getStandaloneCount();
   void getStandalone(unsigned int index, char *output);
   const char *getCStandalone(unsigned int index);
+  void reserveStandalones(size_t count, size_t bytes);
+  size_t getStandaloneData(const char **data, const size_t **offsets);
 
   void set(const char *longKey, bool value);
   void set(const char *longKey, int value);
@@ -155,13 +305,49 @@ public:
 
   void setProgName(const char *_progname);
 
-  void parseFile(const char *filename);
-  void parseLine(const char *line);
+  /*
+   * batch mode: parseArgs(), parseFile() and parseLine() defer all target
+   * writes and callbacks to the end of the parse. Each dirty key is then
+   * committed once, in registration order, followed by a single standalone
+   * callback. beginBatch()/commitBatch() open such a transaction manually and
+   * may be nested.
+   */
+  void setBatchMode(bool batch);
+  void beginBatch();
+  void commitBatch();
+
+  /*
+   * async callbacks: callbacks run on a pool of threads. threads 0: run them
+   * synchronously again, after waiting for the pending ones
+   */
+  void setAsyncCallbacks(unsigned int threads, bool waitAtEnd);
+  void waitForCallbacks();
+  bool callbacksDone();
+
+  void parseFile(const char *filename, Layer fileLayer);
+  // loads all files in parallel, then applies them in order
+  void parseFiles(const char * const *filenames, size_t count,
+    Layer fileLayer);
+  void parseLine(const char *line, Layer lineLayer);
   void parseArgs(int argc, char **argv);
+  void parseCommandString(const char *command, size_t length);
+  void parseEnvironment(const char *prefix, ArgumentParser::KeyCase keyCase);
 
   bool writeFile(const char *filename);
+  bool writeCompletionIndex(const char *filename);
+  /*
+   * shell completion without a parser: answers 'prog --complete words...'
+   * from an index file and exits. Returns false if argv isn't a completion
+   * query or the index can't be read.
+   */
+  static bool complete(int argc, char **argv, const char *indexFile);
 
   void displayHelpMessage();
+
+  MemoryUsage memoryUsage();
+
+  ParseStats getStats();
+  void resetStats();
 };
 
 #endif /* ARGUMENTPARSERINTERNALS_H_ */
@@ -0,0 +1,54 @@
+/*
+ * Bitset.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef BITSET_H_
+#define BITSET_H_
+
+#include <vector>
+#include <cstddef>
+
+/*
+ * growable set of bits, indexed by option id. Bits beyond size() read as 0.
+ */
+class Bitset
+{
+public:
+  typedef unsigned long Word;
+  static const size_t npos = (size_t) -1;
+
+private:
+  static const size_t wordBits = sizeof(Word) * 8;
+
+  std::vector<Word> words;
+  size_t bits;
+
+public:
+  Bitset();
+
+  void resize(size_t size);
+  size_t size() const;
+  // bytes of the words
+  size_t memoryUsage() const;
+
+  void set(size_t index);
+  void reset(size_t index);
+  bool test(size_t index) const;
+
+  // reset all bits, keeping the allocated storage
+  void clear();
+  bool any() const;
+
+  // index of the first set bit at or after start, npos if there is none
+  size_t findNext(size_t start) const;
+
+  // word-wise operations on sets of different sizes
+  Bitset &operator|=(const Bitset &other);
+  bool isSubsetOf(const Bitset &other) const;
+  bool intersects(const Bitset &other) const;
+};
+
+#endif /* BITSET_H_ */
@@ -0,0 +1,74 @@
+/*
+ * CallbackScheduler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef CALLBACKSCHEDULER_H_
+#define CALLBACKSCHEDULER_H_
+
+#include <Schema.hpp>
+#include <WorkerPool.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/*
+ * runs callbacks asynchronously on a WorkerPool.
+ *
+ * The callbacks of a parse are queued as one task per fired key and only
+ * released at the end of the parse, when all ordering constraints are
+ * known: tasks of a key wait for all earlier tasks of the same key and for
+ * the tasks of every key it was ordered after (Schema::registerCallbackOrder).
+ * All other tasks run concurrently.
+ */
+class CallbackScheduler
+{
+private:
+  struct Task
+  {
+    CallbackScheduler *scheduler;
+    unsigned int slot; // id, or the standalone slot
+    Schema::CallbackVector callbacks;
+    ArgumentParser::Event event;
+
+    unsigned int waitingFor; // unfinished predecessors
+    std::vector<Task*> successors;
+  };
+
+  WorkerPool pool;
+
+  std::mutex taskMutex;
+  std::condition_variable finished;
+  size_t unfinished; // queued, waiting or running tasks
+
+  std::vector<Task*> pending; // queued, but not released yet
+  std::vector<Task*> lastTasks; // latest unfinished task per slot
+
+  CallbackScheduler(const CallbackScheduler &other);
+  CallbackScheduler &operator=(const CallbackScheduler &other);
+
+  static void run(void *argument);
+  void finish(Task *task);
+  Task *&lastTask(unsigned int slot);
+  void addPredecessor(Task *task, Task *predecessor);
+
+public:
+  CallbackScheduler(unsigned int threads);
+  // waits for all callbacks
+  ~CallbackScheduler();
+
+  unsigned int getThreadCount() const;
+
+  // id Schema::noId: standalone callbacks
+  void queue(const Schema &schema, unsigned int id,
+    const ArgumentParser::Event &event);
+  // starts all queued tasks, respecting the callback order of the schema
+  void release(const Schema &schema);
+  // blocks until all released tasks have finished
+  void wait();
+  bool done();
+};
+
+#endif /* CALLBACKSCHEDULER_H_ */
@@ -0,0 +1,95 @@
+/*
+ * CompletionIndex.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef COMPLETIONINDEX_H_
+#define COMPLETIONINDEX_H_
+
+#include <Schema.hpp>
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * compact index of all keys and sub-commands for shell completion. It's a
+ * single block without pointers, so it can be written to a file once and
+ * mapped by 'prog --complete ...' without registering any options:
+ *
+ *   Header, Key[keyCount] sorted by name, ShortKey[shortKeyCount] sorted by
+ *   short key, uint32_t[commandCount] sorted sub-command names, strings
+ *
+ * Names are offsets into the '\0'-terminated strings. All numbers are in
+ * native byte order, so an index is only valid on the machine type that
+ * wrote it.
+ */
+class CompletionIndex
+{
+public:
+  static const uint32_t version = 1;
+
+  struct Header
+  {
+    char magic[4]; // "APCI"
+    uint32_t version;
+    uint32_t keyCount;
+    uint32_t shortKeyCount;
+    uint32_t commandCount;
+    uint32_t stringBytes;
+  };
+
+  struct Key
+  {
+    uint32_t name;
+    uint32_t type; // Argument::ValueType
+  };
+
+  struct ShortKey
+  {
+    uint32_t shortKey;
+    uint32_t key; // index into the keys
+  };
+
+  typedef std::vector<char> Buffer;
+
+private:
+  const Header *header;
+  const Key *keys;
+  const ShortKey *shortKeys;
+  const uint32_t *commands;
+  const char *strings;
+
+  const char *name(uint32_t offset) const;
+  // first key whose name isn't less than the prefix
+  const Key *lowerBound(const char *prefix, size_t length) const;
+  const Key *findKey(const char *name, size_t length) const;
+  const Key *findShortKey(unsigned char shortKey) const;
+  bool isCommand(const char *word) const;
+
+  void completeKeys(const char *word, std::ostream &output) const;
+  void completeCommands(const char *word, std::ostream &output) const;
+  static void completeBool(const char *prefix, size_t prefixLength,
+    const char *word, std::ostream &output);
+
+public:
+  CompletionIndex();
+
+  static void build(const Schema &schema,
+    const std::vector<const char*> &commandNames, Buffer &buffer);
+
+  // false if data doesn't hold a valid index. data must stay valid
+  bool open(const char *data, size_t size);
+
+  /*
+   * writes the candidates for the last word, one per line. words are the
+   * arguments after the program name, up to the word that is completed, which
+   * may be empty.
+   */
+  void complete(const char * const *words, size_t count,
+    std::ostream &output) const;
+};
+
+#endif /* COMPLETIONINDEX_H_ */
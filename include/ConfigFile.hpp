@@ -0,0 +1,61 @@
+/*
+ * ConfigFile.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef CONFIGFILE_H_
+#define CONFIGFILE_H_
+
+#include <Schema.hpp>
+#include <tokenize.hpp>
+#include <cstddef>
+#include <vector>
+
+/*
+ * a config file that has been read and split into lines, but not applied
+ * yet. Loading doesn't touch a parser, so several files can be loaded in
+ * parallel and applied in order afterwards.
+ */
+class ConfigFile
+{
+public:
+  struct Entry
+  {
+    LineType type; // never ignoredLine or sectionLine
+    unsigned int line; // 1-based line number
+    const char *text; // the whole line
+    const char *section; // of the last [section] line, NULL if none
+    const char *key; // '\0'-terminated, assignmentLine only. Without section
+    const char *value; // '\0'-terminated, assignmentLine only
+    unsigned int id; // of the key in the schema, Schema::noId if unknown
+  };
+
+  typedef std::vector<Entry> EntryVector;
+
+private:
+  std::vector<char> buffer; // file contents, split in place
+  EntryVector entries;
+  size_t lineCount; // non-empty lines
+  bool opened;
+
+public:
+  // longest key that is looked up, with its section
+  static const size_t maxKeyLength = 1024;
+
+  ConfigFile();
+
+  // writes "section.key" to longKey, false if it's too long
+  static bool joinKey(const char *section, const char *key,
+    size_t keyLength, char *longKey);
+
+  // false if the file can't be opened. Only reads the schema
+  bool load(const char *filename, const Schema &schema);
+
+  bool isOpen() const;
+  size_t getLineCount() const;
+  const EntryVector &getEntries() const;
+};
+
+#endif /* CONFIGFILE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * ConfigPublisherData.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef CONFIGPUBLISHERDATA_H_
+#define CONFIGPUBLISHERDATA_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class ConfigView;
+
+/*
+ * epoch based reclamation of published views.
+ *
+ * A reader claims a slot and stores the global epoch in it before it loads
+ * the current view. publish() swaps the view and retires the previous one
+ * with the epoch at that time. A retired view is deleted as soon as every
+ * active slot holds a younger epoch, since readers with younger epochs
+ * can't have seen it.
+ */
+struct ConfigPublisherData
+{
+  static const size_t cacheLine = 64;
+  static const unsigned int slotCount = 128;
+  static const unsigned long quiescent = 0;
+
+  struct alignas(cacheLine) Slot
+  {
+    std::atomic<bool> used;
+    std::atomic<unsigned long> epoch;
+  };
+
+  struct Retired
+  {
+    const ConfigView *view;
+    unsigned long epoch;
+  };
+
+  alignas(cacheLine) std::atomic<const ConfigView *> current;
+  alignas(cacheLine) std::atomic<unsigned long> epoch;
+  Slot slots[slotCount];
+
+  std::mutex retireMutex;
+  std::vector<Retired> retired;
+
+  ConfigPublisherData(const ConfigView *initial);
+  ~ConfigPublisherData();
+
+  unsigned int claimSlot();
+  void releaseSlot(unsigned int slot);
+
+  void publish(const ConfigView *view);
+  // deletes all retired views that no reader can see anymore
+  void reclaim();
+};
+
+#endif /* CONFIGPUBLISHERDATA_H_ */
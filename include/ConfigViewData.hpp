@@ -0,0 +1,66 @@
+/*
+ * ConfigViewData.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef CONFIGVIEWDATA_H_
+#define CONFIGVIEWDATA_H_
+
+#include <Argument.hpp>
+#include <atomic>
+#include <cstddef>
+
+/*
+ * frozen copy of all values, allocated as a single cache line aligned block:
+ *
+ *   ConfigViewData | entries[count] | standalones[standaloneCount] | strings
+ *
+ * Entries are sorted by key. All pointers point into the same block. Only the
+ * reference count is ever written after creation, so it gets a cache line of
+ * its own.
+ */
+struct ConfigViewData
+{
+  static const size_t cacheLine = 64;
+
+  struct Entry
+  {
+    const char *key;
+    union
+    {
+      bool boolValue;
+      int intValue;
+      unsigned int uintValue;
+      double doubleValue;
+      const char *stringValue;
+    };
+    unsigned char type; // Argument::ValueType
+    bool defined;
+  };
+
+  alignas(cacheLine) std::atomic<unsigned int> references;
+
+  alignas(cacheLine) size_t count;
+  size_t standaloneCount;
+  const Entry *entries;
+  const char * const *standalones;
+
+  // one block with room for all entries, standalones and stringBytes
+  static ConfigViewData *create(size_t count, size_t standaloneCount,
+    size_t stringBytes);
+
+  // the parts of the block, which may only be written before it is shared
+  Entry *entryStorage();
+  const char **standaloneStorage();
+  char *stringStorage();
+
+  // returns NULL for unknown keys
+  const Entry *find(const char *longKey) const;
+
+  void acquire();
+  void release();
+};
+
+#endif /* CONFIGVIEWDATA_H_ */
@@ -0,0 +1,219 @@
+/*
+ * Schema.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef SCHEMA_H_
+#define SCHEMA_H_
+
+#include <Argument.hpp>
+#include <Bitset.hpp>
+#include <Stats.hpp>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/*
+ * registered options: keys, types, defaults, comments, short keys, targets and
+ * callbacks. Options are identified by their id, which is assigned in order of
+ * registration.
+ *
+ * A schema is reference counted. Once it is shared between several parsers,
+ * it must not be modified anymore. Parsing only reads the schema, so shared
+ * schemas can be used from several threads at once.
+ */
+class Schema
+{
+public:
+  typedef void (*Callback)(void*);
+  typedef ArgumentParser::EventCallback EventCallback;
+
+  static const unsigned int noId = (unsigned int) -1;
+
+  struct cmp_str
+  {
+    bool operator()(const char *a, const char* b) const
+    {
+      STATS_ADD(comparisons, 1);
+      return std::strcmp(a, b) < 0;
+    }
+  };
+
+  // plain callbacks are wrapped into event callbacks, which pass data on
+  struct CallbackContainer
+  {
+    EventCallback callback;
+    void *data;
+
+    CallbackContainer(const EventCallback &_callback, void *_data);
+  };
+
+  struct Target
+  {
+    void *pointer;
+    // type of the std::atomic<> at pointer, noType for plain targets
+    Argument::ValueType atomicType;
+    std::memory_order order;
+    size_t size; // capacity of string targets, 0 if unknown
+
+    Target(void *_pointer, Argument::ValueType _atomicType,
+      std::memory_order _order, size_t _size);
+  };
+
+  // comment of an option, either borrowed from static storage or owned
+  struct Comment
+  {
+    size_t length;
+    const char *text; // NULL if there is no comment
+    bool owned;
+
+    Comment();
+  };
+
+  typedef std::vector<Target> TargetVector;
+  typedef std::vector<CallbackContainer> CallbackVector;
+
+  // targets, callbacks and constraints. Most options have none, so they're
+  // only allocated on first use
+  struct Links
+  {
+    TargetVector targets;
+    CallbackVector callbacks;
+    // async callbacks of these ids have to finish before the own ones start
+    std::vector<unsigned int> callbacksAfter;
+    Bitset requirements; // have to be set as well, by value or default
+    Bitset conflicts; // must not be set as well
+  };
+
+  /*
+   * kept compact for schemas with 100k options: key, comment, the default
+   * cell and the links, 64 bytes. Keys, owned comments and links belong to
+   * the schema.
+   */
+  struct Option
+  {
+    const char *longKey;
+    Comment comment;
+    Argument defaultValue; // wasSet() if there is a default
+    Links *links; // NULL if there are none
+    Argument::ValueType type;
+
+    Option(const char *_longKey, Argument::ValueType _type);
+
+    // empty links if there are none
+    const Links &getLinks() const;
+  };
+
+  typedef std::map<const char *, unsigned int, cmp_str> KeyMap;
+  typedef std::vector<Option> OptionVector;
+
+  typedef ArgumentSection::Key SectionKey;
+  // keys of a section, a range of the sorted keys
+  struct SectionRange
+  {
+    unsigned int first;
+    unsigned int count;
+  };
+  typedef std::map<const char *, SectionRange, cmp_str> SectionMap;
+
+private:
+  std::atomic<unsigned int> references;
+
+  KeyMap keys;
+  OptionVector options;
+  unsigned int shortKeys[256];
+
+  // indexed by id
+  Bitset requiredKeys; // typed options without a default
+  Bitset defaultKeys;
+  Bitset constrainedKeys; // options with requirements or conflicts
+
+  CallbackVector standaloneCallbacks;
+  int maxStandalones;
+  size_t standaloneLimit;
+  char *standaloneComment;
+  char *standaloneHelpKey;
+
+  /*
+   * hierarchical index of dotted keys, built on first use: all keys sorted,
+   * so every section (net and net.http of net.http.port) is a range of them.
+   * A schema is only changed while it isn't shared, but shared schemas may
+   * build the index from several threads at once.
+   */
+  mutable std::vector<SectionKey> sortedKeys;
+  mutable std::vector<char> sectionNames; // keys of the section map
+  mutable SectionMap sections;
+  mutable std::atomic<bool> sectionsBuilt;
+  mutable std::mutex sectionsMutex;
+
+  Schema(const Schema &other);
+  Schema &operator=(const Schema &other);
+
+  void clearStandaloneStrings();
+  Links &links(unsigned int id);
+  bool callbacksOrdered(unsigned int before, unsigned int after) const;
+  void buildSections() const;
+
+public:
+  Schema();
+  ~Schema();
+
+  // reference counting. release() deletes the schema with the last reference
+  Schema *acquire();
+  void release();
+  bool isShared() const;
+  // deep copy with a single reference
+  Schema *clone() const;
+
+  unsigned int registerArgument(const char *longKey,
+    Argument::ValueType valueType);
+  Argument *registerDefault(unsigned int id);
+  // call after the default returned by registerDefault() has been changed
+  void updateDefault(unsigned int id);
+  void registerRequirement(unsigned int id, unsigned int requiredId);
+  void registerConflict(unsigned int id, unsigned int conflictingId);
+  void registerShortKey(unsigned char shortKey, unsigned int id);
+  // borrow: keep the pointer instead of copying the comment
+  void registerComment(unsigned int id, const char *comment, bool borrow);
+  void registerTarget(unsigned int id, void *target,
+    Argument::ValueType atomicType = Argument::noType,
+    std::memory_order order = std::memory_order_relaxed, size_t size = 0);
+  void registerCallback(unsigned int id, const EventCallback &callback,
+    void *data);
+  void registerStandaloneCallback(const EventCallback &callback, void *data);
+  // false if the order would contradict an already registered one
+  bool registerCallbackOrder(unsigned int before, unsigned int after);
+  void registerStandalones(int maximum, const char *helpKey,
+    const char *comment);
+
+  unsigned int size() const;
+  unsigned int fetchId(const char *longKey) const;
+  unsigned int fetchShortKey(unsigned char shortKey) const;
+  const Option &getOption(unsigned int id) const;
+  const KeyMap &getKeys() const;
+  /*
+   * keys of a section and all of its subsections, sorted. section "" returns
+   * all keys. false if there's no such section. Valid until the next
+   * registration
+   */
+  bool getSection(const char *section, const SectionKey *&first,
+    size_t &count) const;
+  const Bitset &getRequiredKeys() const;
+  const Bitset &getDefaultKeys() const;
+  const Bitset &getConstrainedKeys() const;
+
+  // adds the memory of the schema to usage, see ArgumentParser::memoryUsage()
+  void addMemoryUsage(MemoryUsage &usage) const;
+
+  const CallbackVector &getStandaloneCallbacks() const;
+  int getMaxStandalones() const;
+  size_t getStandaloneLimit() const;
+  const char *getStandaloneComment() const;
+  const char *getStandaloneHelpKey() const;
+};
+
+#endif /* SCHEMA_H_ */
@@ -0,0 +1,119 @@
+/*
+ * Stats.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <ArgumentParser.h>
+
+/*
+ * collection of ParseStats. A parser activates its statistics for the
+ * duration of its operations (STATS_SCOPE), so code without access to the
+ * parser, like the key comparison or the string arena, can count as well.
+ *
+ * Timings are exclusive: STATS_TIMER adds the time of its scope minus the
+ * time of nested timers, so a callback that parses a file counts as
+ * tokenizing and conversion, not as callback time.
+ *
+ * Without ARGUMENTPARSER_STATS, all macros expand to nothing.
+ */
+#ifdef ARGUMENTPARSER_STATS
+
+#include <chrono>
+
+// statistics of the parser that is currently working in this thread, or NULL
+extern thread_local ParseStats *activeStats;
+
+class StatsScope
+{
+  ParseStats *previous;
+
+  StatsScope(const StatsScope &other);
+  StatsScope &operator=(const StatsScope &other);
+
+public:
+  StatsScope(ParseStats *stats) :
+    previous(activeStats)
+  {
+    activeStats = stats;
+  }
+
+  ~StatsScope()
+  {
+    activeStats = previous;
+  }
+};
+
+class StatsTimer
+{
+  typedef std::chrono::steady_clock Clock;
+
+  // time of finished timers nested in the innermost running timer
+  static thread_local unsigned long long nestedTime;
+
+  unsigned long long ParseStats::*field;
+  unsigned long long outerNestedTime;
+  Clock::time_point start;
+
+  StatsTimer(const StatsTimer &other);
+  StatsTimer &operator=(const StatsTimer &other);
+
+public:
+  StatsTimer(unsigned long long ParseStats::*_field) :
+    field(_field), outerNestedTime(nestedTime), start(Clock::now())
+  {
+    nestedTime = 0;
+  }
+
+  ~StatsTimer()
+  {
+    unsigned long long elapsed = std::chrono::duration_cast<
+      std::chrono::nanoseconds>(Clock::now() - start).count();
+    if (activeStats)
+    {
+      activeStats->*field += elapsed - nestedTime;
+    }
+    nestedTime = outerNestedTime + elapsed;
+  }
+};
+
+#define STATS_SCOPE(stats) StatsScope statsScope(stats)
+#define STATS_TIMER(field) StatsTimer statsTimer(&ParseStats::field)
+#define STATS_ADD(field, amount) \
+  do \
+  { \
+    if (activeStats) \
+    { \
+      activeStats->field += (amount); \
+    } \
+  } while (0)
+#define STATS_MAX(field, value) \
+  do \
+  { \
+    if (activeStats && activeStats->field < (value)) \
+    { \
+      activeStats->field = (value); \
+    } \
+  } while (0)
+
+#else
+
+#define STATS_SCOPE(stats) do {} while (0)
+#define STATS_TIMER(field) do {} while (0)
+#define STATS_ADD(field, amount) do {} while (0)
+#define STATS_MAX(field, value) do {} while (0)
+
+#endif
+
+#define STATS_ALLOCATION(bytes) \
+  do \
+  { \
+    STATS_ADD(allocations, 1); \
+    STATS_ADD(allocatedBytes, bytes); \
+  } while (0)
+
+#endif /* STATS_H_ */
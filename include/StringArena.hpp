@@ -0,0 +1,78 @@
+/*
+ * StringArena.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef STRINGARENA_H_
+#define STRINGARENA_H_
+
+#include <vector>
+#include <cstddef>
+
+/*
+ * stores copies of strings in large blocks. Stored strings never move and
+ * stay valid until they're released or replaced, or until reset(), which
+ * keeps all blocks for reuse.
+ *
+ * Every string gets a room of a power of two bytes. Released rooms are
+ * reused by later strings of the same size class, so a set of values that is
+ * overwritten again and again only takes the room of its live strings.
+ */
+class StringArena
+{
+private:
+  static const size_t blockSize = 4096;
+  static const size_t minRoomSize = 16;
+  static const unsigned int classCount = sizeof(size_t) * 8 - 4;
+
+  struct Block
+  {
+    char *data;
+    size_t size;
+  };
+
+  // in front of every room
+  struct Header
+  {
+    unsigned int arena; // tag of the arena that stored the string
+    unsigned int sizeClass; // the room has minRoomSize << sizeClass bytes
+  };
+
+  std::vector<Block> blocks;
+  size_t current; // index of the block that is filled
+  size_t used; // bytes used in the current block
+  unsigned int tag; // unique per arena, see Header
+  // released rooms of each size class, linked through their first bytes
+  char *freeRooms[classCount];
+
+  StringArena(const StringArena &other);
+  StringArena &operator=(const StringArena &other);
+
+  static Header *header(const char *str);
+  static unsigned int sizeClass(size_t size);
+  char *allocate(unsigned int sizeClass);
+
+public:
+  StringArena();
+  ~StringArena();
+
+  const char *store(const char *str);
+  const char *store(const char *str, size_t length);
+  /*
+   * stores str in place of old, in the room of old if it fits. old is
+   * released otherwise, so it's invalid afterwards either way. old may be
+   * NULL or a string of another arena, which is left alone.
+   */
+  const char *replace(const char *old, const char *str);
+  // gives the room of a string back. Strings of other arenas are ignored
+  void release(const char *str);
+  // true if str was stored by this arena. str is NULL or from any arena
+  bool owns(const char *str) const;
+
+  void reset();
+  size_t capacity() const;
+};
+
+#endif /* STRINGARENA_H_ */
@@ -0,0 +1,153 @@
+/*
+ * ValueSet.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef VALUESET_H_
+#define VALUESET_H_
+
+#include <Argument.hpp>
+#include <Bitset.hpp>
+#include <Schema.hpp>
+#include <StringArena.hpp>
+#include <atomic>
+#include <vector>
+
+/*
+ * values and standalones of a single parse, indexed by option id.
+ * reset() forgets everything but keeps all memory, so a ValueSet can be
+ * reused for the next parse without allocating.
+ *
+ * Values are stored per layer (see ArgumentParser::Layer), each layer in an
+ * array of its own. A mask per option tells which layers have a value, the
+ * top-most one wins. The defaults are kept in the schema. Only the runtime
+ * layer is allocated up front, the others on their first value.
+ *
+ * share() freezes the values, which are then shared by both sets. Each set
+ * keeps the ids it changes afterwards in an overlay on top of them, copying
+ * only their cells, so sharing costs O(1) and every change O(layers).
+ */
+class ValueSet
+{
+public:
+  typedef ArgumentParser::Layer Layer;
+
+private:
+  // standalones are stored back to back, each one terminated by '\0'
+  typedef std::vector<char> StandaloneBuffer;
+  typedef std::vector<size_t> OffsetVector;
+  typedef std::vector<Argument> ArgumentVector;
+  typedef std::vector<unsigned int> IdVector;
+
+  // stored layers, systemLayer to runtimeLayer
+  static const unsigned int layerCount = ArgumentParser::runtimeLayer;
+  static const unsigned int noEntry = ~0u;
+
+  /*
+   * values of all ids, or of the ids that changed on top of a frozen parent.
+   * A level is only written while a single set owns it and never again once
+   * it's shared, so readers of a shared level don't need locks.
+   */
+  struct Level
+  {
+    std::atomic<unsigned int> references;
+    Level *parent; // NULL: the level holds all ids
+
+    // all ids: an array per layer, indexed by layer - 1
+    ArgumentVector layers[layerCount];
+    std::vector<unsigned char> layerMasks; // bit l: layer l has a value
+
+    // changed ids: the cells of entry e are entryCells[e * layerCount...]
+    IdVector entryIds;
+    std::vector<unsigned char> entryMasks;
+    ArgumentVector entryCells;
+    IdVector slots; // open addressing hash of the ids, entry + 1, 0: empty
+
+    // strings of the values of this level
+    StringArena strings;
+
+    explicit Level(Level *_parent);
+    ~Level();
+
+    Level *acquire();
+    void release();
+
+    unsigned int findEntry(unsigned int id) const;
+    void addSlot(unsigned int entry);
+    void clearEntries();
+  };
+
+  Level *level; // owned by this set only
+  unsigned int size; // number of ids
+  StandaloneBuffer standaloneData;
+  OffsetVector standaloneOffsets;
+
+  ValueSet(const ValueSet &other);
+  ValueSet &operator=(const ValueSet &other);
+
+  // level and index (id or entry) of the cells of an id
+  const Level *find(unsigned int id, unsigned int &index) const;
+  static unsigned int getMask(const Level *cells, unsigned int index);
+  // cell of a layer. Unset layers of a level with all ids are unallocated
+  static const Argument &getCell(const Level *cells, unsigned int index,
+    Layer layer);
+  static Layer topLayer(unsigned int mask);
+
+  ArgumentVector &runtimeValues();
+  // new overlay entry in the own level, without cells
+  unsigned int addEntry(unsigned int id, unsigned int mask);
+  // overlay entry of an id in the own level, copies the cells on first use
+  unsigned int writableEntry(unsigned int id);
+  // value of an option in a layer, allocates the layer on first use
+  Argument &at(unsigned int id, Layer layer);
+  void updateMask(unsigned int id, Layer layer);
+
+public:
+  ValueSet();
+  ~ValueSet();
+
+  // add a value for every option that was registered since the last call
+  void update(const Schema &schema);
+  void reset();
+  // freezes the values of other and shares them, see above
+  void share(ValueSet &other);
+  // the frozen values this set is layered on, NULL if none. Sets that share
+  // the same values return the same address
+  const void *sharedValues() const;
+
+  // value of the top-most layer, or an unset value
+  const Argument &operator[](unsigned int id) const;
+  bool isSet(unsigned int id) const;
+  // top-most layer with a value, defaultLayer if there is none
+  Layer getLayer(unsigned int id) const;
+
+  void set(unsigned int id, Layer layer, bool value);
+  void set(unsigned int id, Layer layer, int value);
+  void set(unsigned int id, Layer layer, unsigned int value);
+  void set(unsigned int id, Layer layer, double value);
+  /*
+   * sets a value from a string. Strings are copied into the set, into the
+   * room of the old value if it fits, which is invalid afterwards
+   */
+  void set(unsigned int id, Layer layer, const char *value);
+  /*
+   * forget all values of a layer and free the room of their strings. Sets
+   * the ids whose value changed in changed
+   */
+  void clearLayer(Layer layer, Bitset &changed);
+  // adds the memory of the values, see ArgumentParser::memoryUsage(). Shared
+  // values are counted by every set
+  void addMemoryUsage(MemoryUsage &usage) const;
+  // copy of a string that is valid until reset()
+  const char *store(const char *str);
+
+  void addStandalone(const char *standalone);
+  size_t getStandaloneCount() const;
+  const char *getStandalone(size_t index) const;
+  void reserveStandalones(size_t count, size_t bytes);
+  size_t getStandaloneData(const char **data, const size_t **offsets) const;
+};
+
+#endif /* VALUESET_H_ */
@@ -0,0 +1,67 @@
+/*
+ * WorkerPool.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * small work-stealing thread pool. Every worker has a queue of its own.
+ * Jobs submitted by a worker go to its own queue, which it works off LIFO,
+ * all other jobs are distributed round-robin. Idle workers steal the oldest
+ * jobs of the other queues.
+ *
+ * The destructor runs all queued jobs before it joins the workers.
+ */
+class WorkerPool
+{
+public:
+  typedef void (*Function)(void *argument);
+
+private:
+  struct Job
+  {
+    Function function;
+    void *argument;
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  std::vector<Queue*> queues;
+  std::vector<std::thread> threads;
+
+  std::atomic<size_t> queued; // jobs in all queues
+  std::atomic<unsigned int> nextQueue; // round-robin
+  std::mutex sleepMutex;
+  std::condition_variable wakeup;
+  bool stopping;
+
+  WorkerPool(const WorkerPool &other);
+  WorkerPool &operator=(const WorkerPool &other);
+
+  void run(unsigned int index);
+  bool pop(unsigned int index, Job &job);
+
+public:
+  WorkerPool(unsigned int threadCount);
+  ~WorkerPool();
+
+  unsigned int size() const;
+  void submit(Function function, void *argument);
+};
+
+#endif /* WORKERPOOL_H_ */
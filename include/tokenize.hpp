@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * splits a buffer into shell-like words in place. Words are separated by
+ * whitespace. Single quotes preserve everything up to the next single quote,
+ * double quotes preserve everything but '"' and '\\', which can be escaped
+ * by a backslash. Outside of quotes, a backslash escapes any character.
+ *
+ * The unquoted word is written back into the buffer and terminated by '\0',
+ * so *end must be writable. No memory is allocated.
+ *
+ * @param cursor position to continue at. Advanced past the returned word
+ * @param end end of the buffer
+ * @returns the next word, or NULL if there are no more words
+ */
+char *nextToken(char **cursor, char *end);
+
+enum LineType
+{
+  ignoredLine, // empty, comment or incomplete line
+  assignmentLine,
+  sectionLine, // [section]
+  unexpectedCharacterLine,
+  syntaxErrorLine
+};
+
+/**
+ * splits a config file line of the form "key = value" or "[section]". Keys
+ * and sections may be dotted (net.http.port). Blanks around key, value and
+ * section are stripped. Nothing is written or allocated.
+ *
+ * @param line '\0'-terminated line
+ * @param key, keyEnd range of the key, or of the section for sectionLine
+ * @param value, valueEnd range of the value, only set for assignmentLine
+ * @returns the type of the line
+ */
+LineType splitLine(const char *line, const char **key, const char **keyEnd,
+  const char **value, const char **valueEnd);
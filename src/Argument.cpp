@@ -8,27 +8,109 @@
 #include <Argument.hpp>
 #include <convert.hpp>
 #include <debug.hpp>
+#include <Stats.hpp>
 #include <cstring>
 #include <cstdlib>
 
+static_assert(sizeof(Argument) <= 16, "Argument must fit into 16 bytes");
+
 Argument::Argument(ValueType _wantedType) :
-  stringValue(NULL), defined(false), valueType(_wantedType)
+  stringValue(NULL), defined(false), ownsString(false), valueType(_wantedType)
 {
 }
 
+Argument::Argument(const Argument &other) :
+  stringValue(NULL), defined(false), ownsString(false),
+    valueType(other.valueType)
+{
+  *this = other;
+}
+
+Argument::Argument(Argument &&other) noexcept :
+  stringValue(NULL), defined(other.defined), ownsString(other.ownsString),
+    valueType(other.valueType)
+{
+  switch (getType())
+  {
+  case noType:
+    break;
+  case boolType:
+    boolValue = other.boolValue;
+    break;
+  case intType:
+    intValue = other.intValue;
+    break;
+  case uintType:
+    uintValue = other.uintValue;
+    break;
+  case doubleType:
+    doubleValue = other.doubleValue;
+    break;
+  case stringType:
+    stringValue = other.stringValue;
+    break;
+  }
+
+  other.ownsString = false;
+}
+
 Argument::~Argument()
 {
   clear();
 }
 
+Argument &Argument::operator=(const Argument &other)
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+
+  clear();
+
+  valueType = other.valueType;
+  switch (getType())
+  {
+  case noType:
+    break;
+  case boolType:
+    boolValue = other.boolValue;
+    break;
+  case intType:
+    intValue = other.intValue;
+    break;
+  case uintType:
+    uintValue = other.uintValue;
+    break;
+  case doubleType:
+    doubleValue = other.doubleValue;
+    break;
+  case stringType:
+    if (other.ownsString && other.stringValue != NULL)
+    {
+      stringValue = strdup(other.stringValue);
+      STATS_ALLOCATION(strlen(other.stringValue) + 1);
+      ownsString = true;
+    } else
+    {
+      stringValue = other.stringValue;
+    }
+    break;
+  }
+  defined = other.defined;
+
+  return *this;
+}
+
 void Argument::clear()
 {
-  if (valueType == stringType && stringValue != NULL)
+  if (ownsString && stringValue != NULL)
   {
     free(const_cast<char*>(stringValue));
   }
 
   stringValue = NULL;
+  ownsString = false;
   defined = false;
 }
 
@@ -74,7 +156,7 @@ void Argument::set(const char *value)
   if (value == NULL)
     return;
 
-  switch (valueType)
+  switch (getType())
   {
   case noType:
     break;
@@ -134,20 +216,38 @@ void Argument::set(const char *value)
   case stringType:
   {
     stringValue = strdup(value);
+    STATS_ALLOCATION(strlen(value) + 1);
+    ownsString = true;
     defined = true;
     break;
   }
   }
 }
 
+void Argument::borrow(const char *value)
+{
+  if (valueType != stringType)
+  {
+    set(value);
+    return;
+  }
+
+  clear();
+  if (value == NULL)
+    return;
+
+  stringValue = value;
+  defined = true;
+}
+
 void Argument::setType(ValueType _wantedType)
 {
   valueType = _wantedType;
 }
 
-Argument::ValueType Argument::getType()
+Argument::ValueType Argument::getType() const
 {
-  return valueType;
+  return ValueType(valueType);
 }
 
 bool Argument::hasType(ValueType type) const
@@ -220,3 +320,13 @@ const char *Argument::getString() const
     return NULL;
   }
 }
+
+size_t Argument::memoryUsage() const
+{
+  if (ownsString && stringValue != NULL)
+  {
+    return strlen(stringValue) + 1;
+  }
+
+  return 0;
+}
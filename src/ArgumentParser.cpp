@@ -1,16 +1,74 @@
 #include <ArgumentParser.h>
 #include <ArgumentParserInternals.hpp>
+#include <Schema.hpp>
+
+ArgumentSchema::ArgumentSchema(Schema *_schema) :
+  schema(_schema)
+{
+}
+
+ArgumentSchema::ArgumentSchema(const ArgumentSchema &other) :
+  schema(other.schema->acquire())
+{
+}
+
+ArgumentSchema::~ArgumentSchema()
+{
+  schema->release();
+}
+
+ArgumentSchema &ArgumentSchema::operator=(const ArgumentSchema &other)
+{
+  Schema *previous = schema;
+  schema = other.schema->acquire();
+  previous->release();
+
+  return *this;
+}
 
 ArgumentParser::ArgumentParser(const char *progname) :
   args(new ArgumentParserInternals(progname))
 {
 }
 
+ArgumentParser::ArgumentParser(const ArgumentSchema &schema,
+    const char *progname) :
+  args(new ArgumentParserInternals(schema.schema, progname))
+{
+}
+
+ArgumentParser::ArgumentParser(ArgumentParserInternals *_args) :
+  args(_args)
+{
+}
+
 ArgumentParser::~ArgumentParser()
 {
   delete args;
 }
 
+ArgumentSchema ArgumentParser::getSchema()
+{
+  return ArgumentSchema(args->getSchema());
+}
+
+void ArgumentParser::reset()
+{
+  args->reset();
+}
+
+ConfigView ArgumentParser::snapshot()
+{
+  return ConfigView(args->snapshot());
+}
+
+ArgumentParser *ArgumentParser::clone()
+{
+  ArgumentParser *copy = new ArgumentParser((ArgumentParserInternals*) NULL);
+  copy->args = new ArgumentParserInternals(*args, copy);
+  return copy;
+}
+
 void ArgumentParser::Bool(const char *longKey, const char *comment,
     unsigned char shortKey, bool *target)
 {
@@ -77,12 +135,35 @@ void ArgumentParser::registerCallback(const char *longKey, Callback callback,
   args->registerCallback(longKey, callback, data);
 }
 
+void ArgumentParser::registerCallback(const char *longKey,
+    const EventCallback &callback, void *data)
+{
+  args->registerCallback(longKey, callback, data);
+}
+
+void ArgumentParser::registerCallbackOrder(const char *before,
+    const char *after)
+{
+  args->registerCallbackOrder(before, after);
+}
+
 void ArgumentParser::Standalones(int maximum, const char *helpKey,
     const char *comment)
 {
   args->Standalones(maximum, helpKey, comment);
 }
 
+void ArgumentParser::addSubcommand(const char *name, SubcommandInit init,
+    void *data, const char *comment)
+{
+  args->addSubcommand(this, name, init, data, comment);
+}
+
+const char *ArgumentParser::getSubcommand()
+{
+  return args->getSubcommand();
+}
+
 // if one of the keys are encountered, a file is included (read in place)
 void ArgumentParser::File(const char *longKey, const char *comment,
     unsigned char shortKey)
@@ -90,6 +171,21 @@ void ArgumentParser::File(const char *longKey, const char *comment,
   args->File(longKey, comment, shortKey);
 }
 
+void ArgumentParser::bindStruct(void *base, const Field *fields, size_t count)
+{
+  args->bindStruct(base, fields, count);
+}
+
+bool ArgumentParser::writeStruct(const char *filename, const void *base)
+{
+  return args->writeStruct(filename, base);
+}
+
+void ArgumentParser::setStaticStrings(bool isStatic)
+{
+  args->setStaticStrings(isStatic);
+}
+
 void ArgumentParser::registerShortKey(unsigned char shortKey,
     const char *longKey)
 {
@@ -106,16 +202,69 @@ void ArgumentParser::registerTarget(const char *longKey, void *target)
   args->registerTarget(longKey, target);
 }
 
+void ArgumentParser::registerTarget(const char *longKey,
+    std::atomic<bool> *target, std::memory_order order)
+{
+  args->registerAtomicTarget(longKey, target, Argument::boolType, order);
+}
+
+void ArgumentParser::registerTarget(const char *longKey,
+    std::atomic<int> *target, std::memory_order order)
+{
+  args->registerAtomicTarget(longKey, target, Argument::intType, order);
+}
+
+void ArgumentParser::registerTarget(const char *longKey,
+    std::atomic<unsigned int> *target, std::memory_order order)
+{
+  args->registerAtomicTarget(longKey, target, Argument::uintType, order);
+}
+
+void ArgumentParser::registerTarget(const char *longKey,
+    std::atomic<double> *target, std::memory_order order)
+{
+  args->registerAtomicTarget(longKey, target, Argument::doubleType, order);
+}
+
 bool ArgumentParser::keyExists(const char *longKey)
 {
   return args->keyExists(longKey);
 }
 
+int ArgumentParser::getId(const char *longKey)
+{
+  return args->getId(longKey);
+}
+
+const ArgumentValue * const *ArgumentParser::getValueTable()
+{
+  return args->getValueTable();
+}
+
+ArgumentSection ArgumentParser::getSection(const char *section)
+{
+  const ArgumentSection::Key *keys;
+  size_t count;
+  args->getSection(section, keys, count);
+  return ArgumentSection(keys, count,
+    section[0] == '\0' ? 0 : strlen(section) + 1);
+}
+
 bool ArgumentParser::wasValueSet(const char *longKey, bool includeDefault)
 {
   return args->wasValueSet(longKey, includeDefault);
 }
 
+ArgumentParser::Layer ArgumentParser::getLayer(const char *longKey)
+{
+  return args->getLayer(longKey);
+}
+
+void ArgumentParser::clearLayer(Layer layer)
+{
+  args->clearLayer(layer);
+}
+
 bool ArgumentParser::shortKeyExists(unsigned char shortKey)
 {
   return args->shortKeyExists(shortKey);
@@ -131,6 +280,23 @@ bool ArgumentParser::allValuesSet(const char *errorFormat)
   return args->allValuesSet(errorFormat);
 }
 
+void ArgumentParser::registerRequirement(const char *longKey,
+    const char *requiredKey)
+{
+  args->registerRequirement(longKey, requiredKey);
+}
+
+void ArgumentParser::registerConflict(const char *longKey,
+    const char *conflictingKey)
+{
+  args->registerConflict(longKey, conflictingKey);
+}
+
+bool ArgumentParser::checkConstraints(bool verbose)
+{
+  return args->checkConstraints(verbose);
+}
+
 bool ArgumentParser::getBool(const char *longKey)
 {
   return args->getBool(longKey);
@@ -176,6 +342,20 @@ const char *ArgumentParser::getCStandalone(unsigned int index)
   return args->getCStandalone(index);
 }
 
+ArgumentParser::StandaloneList ArgumentParser::getStandalones()
+{
+  const char *data;
+  const size_t *offsets;
+  size_t count = args->getStandaloneData(&data, &offsets);
+
+  return StandaloneList(data, offsets, count);
+}
+
+void ArgumentParser::reserveStandalones(size_t count, size_t bytes)
+{
+  args->reserveStandalones(count, bytes);
+}
+
 void ArgumentParser::set(const char *longKey, bool value)
 {
   args->set(longKey, value);
@@ -206,14 +386,50 @@ void ArgumentParser::setProgName(const char *progname)
   args->setProgName(progname);
 }
 
-void ArgumentParser::parseFile(const char *filename)
+void ArgumentParser::setBatchMode(bool batch)
 {
-  args->parseFile(filename);
+  args->setBatchMode(batch);
 }
 
-void ArgumentParser::parseLine(const char *line)
+void ArgumentParser::beginBatch()
 {
-  args->parseLine(line);
+  args->beginBatch();
+}
+
+void ArgumentParser::commitBatch()
+{
+  args->commitBatch();
+}
+
+void ArgumentParser::setAsyncCallbacks(unsigned int threads, bool waitAtEnd)
+{
+  args->setAsyncCallbacks(threads, waitAtEnd);
+}
+
+void ArgumentParser::waitForCallbacks()
+{
+  args->waitForCallbacks();
+}
+
+bool ArgumentParser::callbacksDone()
+{
+  return args->callbacksDone();
+}
+
+void ArgumentParser::parseFile(const char *filename, Layer layer)
+{
+  args->parseFile(filename, layer);
+}
+
+void ArgumentParser::parseFiles(const char * const *filenames, size_t count,
+    Layer layer)
+{
+  args->parseFiles(filenames, count, layer);
+}
+
+void ArgumentParser::parseLine(const char *line, Layer layer)
+{
+  args->parseLine(line, layer);
 }
 
 void ArgumentParser::parseArgs(int argc, char **argv)
@@ -221,12 +437,47 @@ void ArgumentParser::parseArgs(int argc, char **argv)
   args->parseArgs(argc, argv);
 }
 
+void ArgumentParser::parseCommandString(const char *command, size_t length)
+{
+  args->parseCommandString(command, length);
+}
+
+void ArgumentParser::parseEnvironment(const char *prefix, KeyCase keyCase)
+{
+  args->parseEnvironment(prefix, keyCase);
+}
+
 bool ArgumentParser::writeFile(const char *filename)
 {
   return args->writeFile(filename);
 }
 
+bool ArgumentParser::writeCompletionIndex(const char *filename)
+{
+  return args->writeCompletionIndex(filename);
+}
+
+bool ArgumentParser::complete(int argc, char **argv, const char *indexFile)
+{
+  return ArgumentParserInternals::complete(argc, argv, indexFile);
+}
+
 void ArgumentParser::displayHelpMessage()
 {
   args->displayHelpMessage();
 }
+
+MemoryUsage ArgumentParser::memoryUsage()
+{
+  return args->memoryUsage();
+}
+
+ParseStats ArgumentParser::getStats()
+{
+  return args->getStats();
+}
+
+void ArgumentParser::resetStats()
+{
+  args->resetStats();
+}
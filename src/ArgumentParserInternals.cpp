@@ -6,137 +6,225 @@
  */
 
 #include <ArgumentParserInternals.hpp>
+#include <CompletionIndex.hpp>
+#include <ConfigFile.hpp>
 #include <debug.hpp>
+#include <tokenize.hpp>
 #include <cctype>
 #include <fstream>
 #include <cstdlib>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+
+// POSIX, but not declared by every unistd.h
+extern char **environ;
 
 using namespace std;
 
-ArgumentParserInternals::CallbackContainer::CallbackContainer(
-  Callback _callback, void *_data) :
-  callback(_callback), data(_data)
+ArgumentParserInternals::Source::Source() :
+  argIndex(-1), file(NULL), line(0)
 {
 }
 
 ArgumentParserInternals::ArgumentParserInternals(const char *_progname) :
-  shortKeys(new char*[256]), maxStandalones(0), standaloneComment(NULL),
-    standaloneHelpKey(strdup("argument"))
+  schema(new Schema()), valueCells(NULL), batchParsing(false), batchDepth(0),
+    dirtyStandalones(false), includeDepth(0), staticStrings(false),
+    scheduler(NULL), waitForCallbacksAtEnd(true), callbackDepth(0),
+    layer(ArgumentParser::runtimeLayer), subcommand(noId),
+    subcommandFirstId(noId)
 {
   progname = strdup(_progname);
-  for (int i = 0; i < 256; ++i)
-  {
-    shortKeys[i] = NULL;
-  }
+  resetStats();
 
+  // the comment is a literal
+  staticStrings = true;
   Bool("help", false, "display help message and exit", 'h', NULL);
+  staticStrings = false;
 }
 
-ArgumentParserInternals::~ArgumentParserInternals()
+ArgumentParserInternals::ArgumentParserInternals(Schema *_schema,
+  const char *_progname) :
+  schema(_schema->acquire()), valueCells(NULL), batchParsing(false),
+    batchDepth(0),
+    dirtyStandalones(false), includeDepth(0), staticStrings(false),
+    scheduler(NULL), waitForCallbacksAtEnd(true), callbackDepth(0),
+    layer(ArgumentParser::runtimeLayer), subcommand(noId),
+    subcommandFirstId(noId)
 {
-  clearAll();
-  delete[] shortKeys;
-  free(progname);
+  progname = strdup(_progname);
+  resetStats();
+
+  values.update(*schema);
+  dirtyKeys.resize(schema->size());
+  dirtySources.resize(schema->size());
 }
 
-void ArgumentParserInternals::clearShortKeys()
+ArgumentParserInternals::ArgumentParserInternals(
+  ArgumentParserInternals &other, ArgumentParser *parser) :
+  schema(other.schema->acquire()), valueCells(NULL), setKeys(other.setKeys),
+    batchParsing(other.batchParsing), batchDepth(0), dirtyStandalones(false),
+    includeDepth(0), staticStrings(other.staticStrings), scheduler(NULL),
+    waitForCallbacksAtEnd(true), callbackDepth(0), layer(other.layer),
+    subcommands(other.subcommands), subcommand(other.subcommand),
+    subcommandFirstId(other.subcommandFirstId), bindings(other.bindings)
 {
-  for (int shortKey = 0; shortKey < 256; ++shortKey)
+  progname = strdup(other.progname);
+  lineSection = other.lineSection;
+  resetStats();
+
+  // pending callbacks of other may still set values
+  other.waitForCallbacks();
+  values.share(other.values);
+
+  for (SubcommandVector::iterator it = subcommands.begin();
+    it != subcommands.end(); ++it)
   {
-    clearShortKey((unsigned char) shortKey);
+    it->name = strdup(it->name);
+    it->comment = it->comment != NULL ? strdup(it->comment) : NULL;
+    it->parser = parser;
   }
 }
 
-void ArgumentParserInternals::clearShortKey(unsigned char shortKey)
+ArgumentParserInternals::~ArgumentParserInternals()
 {
-  if (shortKeys[shortKey] != NULL)
+  // waits for the callbacks, which may still read strings of the values
+  delete scheduler;
+
+  for (SubcommandVector::iterator it = subcommands.begin();
+    it != subcommands.end(); ++it)
   {
-    free(shortKeys[shortKey]);
-    shortKeys[shortKey] = NULL;
+    free(it->name);
+    free(it->comment);
   }
+  schema->release();
+  free(progname);
 }
 
-void ArgumentParserInternals::clearArguments()
+Schema *ArgumentParserInternals::writableSchema()
 {
-  while (!arguments.empty())
+  if (schema->isShared())
   {
-    ArgumentMap::iterator it = arguments.begin();
-    free(const_cast<char*>(it->first));
-    arguments.erase(it);
+    Schema *copy = schema->clone();
+    schema->release();
+    schema = copy;
+
+    // defaults in the value table pointed into the shared schema
+    for (unsigned int id = 0; id < schema->size(); ++id)
+    {
+      updateValueCell(id);
+    }
   }
+
+  return schema;
 }
 
-void ArgumentParserInternals::clearTargets()
+Schema *ArgumentParserInternals::getSchema()
 {
-  while (!targets.empty())
-  {
-    TargetMap::iterator it = targets.begin();
-    free(const_cast<char*>(it->first));
-    targets.erase(it);
-  }
+  return schema->acquire();
 }
 
-void ArgumentParserInternals::clearDefaults()
+ConfigViewData *ArgumentParserInternals::snapshot()
 {
-  while (!defaults.empty())
+  STATS_SCOPE(&stats);
+  const Schema::KeyMap &keys = schema->getKeys();
+  size_t standaloneCount = values.getStandaloneCount();
+
+  size_t stringBytes = 0;
+  for (Schema::KeyMap::const_iterator it = keys.begin(); it != keys.end();
+    ++it)
   {
-    ArgumentMap::iterator it = defaults.begin();
-    free(const_cast<char*>(it->first));
-    defaults.erase(it);
+    stringBytes += strlen(it->first) + 1;
+    Argument *argument = fetchArgument(it->second, true);
+    if (argument->wasSet() && argument->hasType(Argument::stringType))
+    {
+      stringBytes += strlen(argument->getString()) + 1;
+    }
   }
-}
-
-void ArgumentParserInternals::clearComments()
-{
-  while (!comments.empty())
+  for (size_t index = 0; index < standaloneCount; ++index)
   {
-    CommentMap::iterator it = comments.begin();
-    free(const_cast<char*>(it->first));
-    free(const_cast<char*>(it->second));
-    comments.erase(it);
+    stringBytes += strlen(values.getStandalone(index)) + 1;
   }
-}
 
-void ArgumentParserInternals::clearStandalones()
-{
-  for (StandaloneVector::iterator it = standalones.begin();
-    it != standalones.end(); ++it)
+  ConfigViewData *data = ConfigViewData::create(keys.size(), standaloneCount,
+    stringBytes);
+  if (data == NULL)
   {
-    free(const_cast<char*>(*it));
+    throw bad_alloc();
   }
 
-  standalones.clear();
-  if (standaloneHelpKey)
+  ConfigViewData::Entry *entry = data->entryStorage();
+  char *strings = data->stringStorage();
+  for (Schema::KeyMap::const_iterator it = keys.begin(); it != keys.end();
+    ++it, ++entry)
   {
-    free(standaloneHelpKey);
-    standaloneHelpKey = NULL;
+    Argument *argument = fetchArgument(it->second, true);
+
+    size_t length = strlen(it->first) + 1;
+    entry->key = (const char *) memcpy(strings, it->first, length);
+    strings += length;
+
+    entry->type = argument->getType();
+    entry->defined = argument->wasSet();
+    entry->doubleValue = 0.0;
+    if (!entry->defined)
+    {
+      continue;
+    }
+
+    switch (argument->getType())
+    {
+    case Argument::noType:
+      break;
+    case Argument::boolType:
+      entry->boolValue = argument->getBool();
+      break;
+    case Argument::intType:
+      entry->intValue = argument->getInt();
+      break;
+    case Argument::uintType:
+      entry->uintValue = argument->getUInt();
+      break;
+    case Argument::doubleType:
+      entry->doubleValue = argument->getDouble();
+      break;
+    case Argument::stringType:
+      length = strlen(argument->getString()) + 1;
+      entry->stringValue = (const char *) memcpy(strings,
+        argument->getString(), length);
+      strings += length;
+      break;
+    }
   }
-  if (standaloneComment)
+
+  const char **standalones = data->standaloneStorage();
+  for (size_t index = 0; index < standaloneCount; ++index)
   {
-    free(standaloneComment);
-    standaloneComment = NULL;
+    size_t length = strlen(values.getStandalone(index)) + 1;
+    standalones[index] = (const char *) memcpy(strings,
+      values.getStandalone(index), length);
+    strings += length;
   }
+
+  return data;
 }
 
-void ArgumentParserInternals::clearCallbacks()
+void ArgumentParserInternals::reset()
 {
-  while (!callbacks.empty())
+  waitForCallbacks();
+  values.reset();
+  for (size_t id = setKeys.findNext(0); id != Bitset::npos;
+    id = setKeys.findNext(id + 1))
   {
-    CallbackMap::iterator it = callbacks.begin();
-    free(const_cast<char*>(it->first));
-    callbacks.erase(it);
+    updateValueCell(id);
   }
-}
-
-void ArgumentParserInternals::clearAll()
-{
-  clearShortKeys();
-  clearArguments();
-  clearTargets();
-  clearDefaults();
-  clearComments();
-  clearStandalones();
-  clearCallbacks();
+  setKeys.clear();
+  dirtyKeys.clear();
+  dirtyStandalones = false;
+  lineSection.clear();
 }
 
 void ArgumentParserInternals::lookForHelp()
@@ -150,16 +238,31 @@ void ArgumentParserInternals::lookForHelp()
 
 bool validateKey(const char *longKey)
 {
+  // alphanumeric parts, separated by single dots
   const char *keyEnd = longKey;
-  while (isalnum(*keyEnd))
+  for (;;)
   {
+    const char *part = keyEnd;
+    while (isalnum(*keyEnd))
+    {
+      ++keyEnd;
+    }
+
+    if (keyEnd == part)
+    {
+      return false;
+    }
+    if (*keyEnd != '.')
+    {
+      break;
+    }
     ++keyEnd;
   }
 
-  return (keyEnd != longKey && *keyEnd == '\0');
+  return *keyEnd == '\0';
 }
 
-Argument *ArgumentParserInternals::registerArgument(const char *longKey,
+unsigned int ArgumentParserInternals::registerArgument(const char *longKey,
   Argument::ValueType valueType)
 {
   if (!validateKey(longKey))
@@ -167,179 +270,314 @@ Argument *ArgumentParserInternals::registerArgument(const char *longKey,
 #ifdef DEBUG
     cerr << "ERROR: invalid key: '" << longKey << "'" << endl;
 #endif
-    return NULL;
+    return noId;
     //    throw runtime_error("invalid args key");
   }
 
-  ArgumentMap::iterator it = arguments.find(longKey);
-  if (it == arguments.end())
+  STATS_SCOPE(&stats);
+  STATS_TIMER(registrationTime);
+  STATS_ADD(lookups, 1);
+
+  unsigned int id = schema->fetchId(longKey);
+  if (id == noId)
   {
-    pair<ArgumentMap::iterator, bool> ret;
-    ret = arguments.insert(
-      ArgumentMap::value_type(strdup(longKey), Argument(valueType)));
+    // owned string defaults move with the options when they grow
+    const Schema::Option *options =
+      schema->size() != 0 ? &schema->getOption(0) : NULL;
 
-    if (ret.second != true)
-    {
-#ifdef DEBUG
-      cerr << "argument already registered: " << longkey << endl;
-#endif
-      return NULL;
-    }
-    it = ret.first;
+    id = writableSchema()->registerArgument(longKey, valueType);
+    values.update(*schema);
+    dirtyKeys.resize(schema->size());
+    dirtySources.resize(schema->size());
+    updateValueTable(options != &schema->getOption(0));
   }
 
-  return &it->second;
+  return id;
 }
 
-Argument *ArgumentParserInternals::registerDefault(const char *longKey,
-  Argument::ValueType valueType)
+const char *ArgumentParserInternals::storeFileName(const char *filename)
 {
-  ArgumentMap::iterator it = defaults.find(longKey);
-  if (it == defaults.end())
+  FileNameSet::const_iterator it = fileNames.find(filename);
+  if (it != fileNames.end())
   {
-    pair<ArgumentMap::iterator, bool> ret;
-    ret = defaults.insert(
-      ArgumentMap::value_type(strdup(longKey), Argument(valueType)));
-
-    if (ret.second != true)
-    {
-#ifdef DEBUG
-      cerr << "default value already exists: " << longkey << endl;
-#endif
-    }
-    it = ret.first;
+    return *it;
   }
 
-  return &it->second;
+  const char *copy = fileNameStrings.store(filename);
+  fileNames.insert(copy);
+
+  return copy;
 }
 
-Argument *ArgumentParserInternals::fetchDefault(const char *longKey)
+#include<iostream>
+void ArgumentParserInternals::addStandalone(const char *standalone)
 {
-  ArgumentMap::iterator it = defaults.find(longKey);
-
-  if (it == defaults.end())
+  if (values.getStandaloneCount() >= schema->getStandaloneLimit())
   {
-    return NULL;
-  } else
+    //    throw runtime_error("maximum number of standalone arguments exceeded");
+    return;
+  }
+
+  values.addStandalone(standalone);
+
+  if (!schema->getStandaloneCallbacks().empty())
   {
-    return &it->second;
+    // call standalone callback!
+    commitStandalones();
   }
 }
 
-#include<iostream>
-void ArgumentParserInternals::addStandalone(const char *standalone)
+void ArgumentParserInternals::initEvent(ArgumentParser::Event &event,
+  const Source &source)
 {
-  if (maxStandalones != -1 && standalones.size() >= (unsigned) maxStandalones)
+  event.argIndex = source.argIndex;
+  event.file = source.file;
+  event.line = source.line;
+  event.data = NULL;
+}
+
+void ArgumentParserInternals::fireStandaloneCallbacks(const Source &source)
+{
+  const Schema::CallbackVector &callbacks = schema->getStandaloneCallbacks();
+  STATS_SCOPE(&stats);
+  STATS_TIMER(callbackTime);
+  STATS_ADD(callbacksFired, callbacks.size());
+
+  ArgumentParser::Event event;
+  initEvent(event, source);
+  event.id = noId;
+  event.longKey = NULL;
+  event.type = ArgumentParser::Event::stringType;
+  size_t count = values.getStandaloneCount();
+  event.value.stringValue = count ? values.getStandalone(count - 1) : NULL;
+
+  if (scheduler)
   {
-    //    throw runtime_error("maximum number of standalone arguments exceeded");
+    // further standalones may move the standalone data
+    if (callbacks.empty())
+    {
+      return;
+    }
+    if (event.value.stringValue != NULL)
+    {
+      event.value.stringValue = values.store(event.value.stringValue);
+    }
+    scheduler->queue(*schema, noId, event);
+    if (callbackDepth == 0)
+    {
+      scheduler->release(*schema);
+    }
     return;
   }
 
-  standalones.push_back(strdup(standalone));
-  // call standalone callback!
-  fireCallbacks("");
+  for (Schema::CallbackVector::const_iterator it = callbacks.begin();
+    it != callbacks.end(); ++it)
+  {
+    event.data = it->data;
+    it->callback(event);
+  }
 }
 
-void ArgumentParserInternals::fireCallbacks(const char *longKey)
+void ArgumentParserInternals::fireCallbacks(unsigned int id,
+  const Source &source)
 {
-  CallbackRange range = callbacks.equal_range(longKey);
+  const Schema::CallbackVector &callbacks =
+    schema->getOption(id).getLinks().callbacks;
+  if (callbacks.empty())
+  {
+    return;
+  }
+
+  ArgumentParser::Event event;
+  initEvent(event, source);
+  event.id = id;
+  event.longKey = schema->getOption(id).longKey;
+
+  const Argument *argument = fetchArgument(id, true);
+  event.type = ArgumentParser::Event::Type(argument->getType());
+  switch (argument->getType())
+  {
+  case Argument::noType:
+    event.value.stringValue = NULL;
+    break;
+  case Argument::boolType:
+    event.value.boolValue = argument->getBool();
+    break;
+  case Argument::intType:
+    event.value.intValue = argument->getInt();
+    break;
+  case Argument::uintType:
+    event.value.uintValue = argument->getUInt();
+    break;
+  case Argument::doubleType:
+    event.value.doubleValue = argument->getDouble();
+    break;
+  case Argument::stringType:
+    event.value.stringValue = argument->getString();
+    break;
+  }
+
+  STATS_SCOPE(&stats);
+  STATS_TIMER(callbackTime);
+  STATS_ADD(callbacksFired, callbacks.size());
+
+  if (scheduler)
+  {
+    // the value may be overwritten before the callbacks run
+    if (event.type == ArgumentParser::Event::stringType
+      && event.value.stringValue != NULL)
+    {
+      event.value.stringValue = values.store(event.value.stringValue);
+    }
+    scheduler->queue(*schema, id, event);
+    if (callbackDepth == 0)
+    {
+      scheduler->release(*schema);
+    }
+    return;
+  }
+
 #ifdef DEBUG
-  cout << "range for " << longKey << "' :"
-  << (range.first == range.second ? "empty" : "full") << endl;
+  cout << "callbacks for " << schema->getOption(id).longKey << "' :"
+  << (callbacks.empty() ? "empty" : "full") << endl;
 #endif
 
-  for (CallbackMap::iterator it = range.first; it != range.second; ++it)
+  for (Schema::CallbackVector::const_iterator it = callbacks.begin();
+    it != callbacks.end(); ++it)
   {
 #ifdef DEBUG
-    cout << "firing '" << longKey << "'" << endl;
+    cout << "firing '" << schema->getOption(id).longKey << "'" << endl;
 #endif
 
-    Callback callback = it->second.callback;
-    void *data = it->second.data;
-
-    callback(data);
+    event.data = it->data;
+    it->callback(event);
   }
 }
 
-Argument *ArgumentParserInternals::fetchArgument(const char *longKey,
+unsigned int ArgumentParserInternals::fetchId(const char *longKey)
+{
+  STATS_SCOPE(&stats);
+  STATS_ADD(lookups, 1);
+
+  return schema->fetchId(longKey);
+}
+
+Argument *ArgumentParserInternals::fetchArgument(unsigned int id,
   bool useDefault)
 {
-  ArgumentMap::iterator it = arguments.find(longKey);
+  Argument *argument = const_cast<Argument*>(&values[id]);
 
-  if (it == arguments.end())
+  if (useDefault && argument->wasSet() == false)
   {
-    if (useDefault)
+    const Argument &defaultValue = schema->getOption(id).defaultValue;
+    if (defaultValue.wasSet())
     {
-      return fetchDefault(longKey);
-    } else
-    {
-      return NULL;
+      return const_cast<Argument*>(&defaultValue);
     }
-  } else
+  }
+
+  return argument;
+}
+
+int ArgumentParserInternals::getId(const char *longKey)
+{
+  return (int) fetchId(longKey);
+}
+
+void ArgumentParserInternals::getSection(const char *section,
+  const ArgumentSection::Key *&keys, size_t &count)
+{
+  STATS_SCOPE(&stats);
+  STATS_ADD(lookups, 1);
+
+  schema->getSection(section, keys, count);
+}
+
+const ArgumentValue * const *ArgumentParserInternals::getValueTable()
+{
+  if (valueTable.empty())
   {
-    if (useDefault && it->second.wasSet() == false)
-    {
-      return fetchDefault(longKey);
-    }
-    return &it->second;
+    valueTable.resize(1);
+    memset(&valueTable[0], 0, sizeof(ArgumentValue));
+    updateValueTable(true);
+  }
+  return &valueCells;
+}
+
+Argument *ArgumentParserInternals::fetchArgument(const char *longKey,
+  bool useDefault)
+{
+  unsigned int id = fetchId(longKey);
+
+  if (id == noId)
+  {
+    return NULL;
   }
+
+  return fetchArgument(id, useDefault);
 }
 
 void ArgumentParserInternals::registerTarget(const char *longKey, void *target)
 {
   if (target != NULL)
   {
-    if (longKey != NULL)
+    unsigned int id = fetchId(longKey);
+    if (id != noId)
     {
-      if (keyExists(longKey))
-      {
-        targets.insert(TargetMap::value_type(strdup(longKey), target));
-      }
+      writableSchema()->registerTarget(id, target);
     }
   }
 }
 
-void ArgumentParserInternals::registerComment(const char *longKey,
-  const char *comment)
+void ArgumentParserInternals::registerAtomicTarget(const char *longKey,
+  void *target, Argument::ValueType type, memory_order order)
 {
-  if (comment == NULL)
+  if (target == NULL)
   {
     return;
   }
 
-  CommentMap::iterator it = comments.find(longKey);
-  if (it == comments.end())
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
   {
-    pair<CommentMap::iterator, bool> ret;
-    ret = comments.insert(
-      CommentMap::value_type(strdup(longKey), strdup(comment)));
-    if (ret.second != true)
-    {
-#ifdef DEBUG
-      cerr << "Comment already registered: " << longkey << endl;
-#endif
-      // TODO overwrite comment or print error
-      return;
-    }
-    it = ret.first;
-  } else
+    return;
+  }
+
+  if (schema->getOption(id).type != type)
+  {
+    cerr << "error: atomic target doesn't match the type of option '"
+      << longKey << "'" << endl;
+    return;
+  }
+
+  // stores can't have acquire semantics
+  if (order != memory_order_relaxed && order != memory_order_seq_cst)
   {
-    free(const_cast<char*>(it->second));
-    it->second = strdup(comment);
+    order = memory_order_release;
   }
 
+  writableSchema()->registerTarget(id, target, type, order);
 }
 
-const char *ArgumentParserInternals::fetchComment(const char *longKey)
+void ArgumentParserInternals::setStaticStrings(bool isStatic)
 {
-  CommentMap::iterator it = comments.find(longKey);
+  staticStrings = isStatic;
+}
 
-  if (it == comments.end())
+void ArgumentParserInternals::registerComment(const char *longKey,
+  const char *comment)
+{
+  if (comment == NULL)
   {
-    return NULL;
-  } else
+    return;
+  }
+
+  unsigned int id = fetchId(longKey);
+  if (id != noId)
   {
-    return it->second;
+    STATS_SCOPE(&stats);
+    STATS_TIMER(registrationTime);
+    writableSchema()->registerComment(id, comment, staticStrings);
   }
 }
 
@@ -359,8 +597,13 @@ void ArgumentParserInternals::Bool(const char *longKey, bool defaultValue,
   const char *comment, unsigned char shortKey, bool *target)
 {
   Bool(longKey, comment, shortKey, target);
-  Argument *argument = registerDefault(longKey, Argument::boolType);
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+    return;
+  Argument *argument = writableSchema()->registerDefault(id);
   argument->set(defaultValue);
+  writableSchema()->updateDefault(id);
+  updateValueCell(id);
   setTarget(argument, target);
 }
 
@@ -380,8 +623,13 @@ void ArgumentParserInternals::Int(const char *longKey, int defaultValue,
   const char *comment, unsigned char shortKey, int *target)
 {
   Int(longKey, comment, shortKey, target);
-  Argument *argument = registerDefault(longKey, Argument::intType);
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+    return;
+  Argument *argument = writableSchema()->registerDefault(id);
   argument->set(defaultValue);
+  writableSchema()->updateDefault(id);
+  updateValueCell(id);
   setTarget(argument, target);
 }
 
@@ -402,8 +650,13 @@ void ArgumentParserInternals::UInt(const char *longKey,
   unsigned int *target)
 {
   UInt(longKey, comment, shortKey, target);
-  Argument *argument = registerDefault(longKey, Argument::uintType);
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+    return;
+  Argument *argument = writableSchema()->registerDefault(id);
   argument->set(defaultValue);
+  writableSchema()->updateDefault(id);
+  updateValueCell(id);
   setTarget(argument, target);
 }
 
@@ -423,8 +676,13 @@ void ArgumentParserInternals::Double(const char *longKey, double defaultValue,
   const char *comment, unsigned char shortKey, double *target)
 {
   Double(longKey, comment, shortKey, target);
-  Argument *argument = registerDefault(longKey, Argument::doubleType);
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+    return;
+  Argument *argument = writableSchema()->registerDefault(id);
   argument->set(defaultValue);
+  writableSchema()->updateDefault(id);
+  updateValueCell(id);
   setTarget(argument, target);
 }
 
@@ -445,21 +703,40 @@ void ArgumentParserInternals::String(const char *longKey,
   char *target)
 {
   String(longKey, comment, shortKey, target);
-  Argument *argument = registerDefault(longKey, Argument::stringType);
-  argument->set(defaultValue);
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+    return;
+  Argument *argument = writableSchema()->registerDefault(id);
+  if (staticStrings)
+  {
+    argument->borrow(defaultValue);
+  } else
+  {
+    argument->set(defaultValue);
+  }
+  writableSchema()->updateDefault(id);
+  updateValueCell(id);
   setTarget(argument, target);
 }
 
 void ArgumentParserInternals::registerCallback(const char *longKey,
   Callback callback, void* data)
+{
+  registerCallback(longKey, [callback](const ArgumentParser::Event &event)
+  {
+    callback(event.data);
+  }, data);
+}
+
+void ArgumentParserInternals::registerCallback(const char *longKey,
+  const EventCallback &callback, void *data)
 {
   if (longKey)
   {
-    if (keyExists(longKey))
+    unsigned int id = fetchId(longKey);
+    if (id != noId)
     {
-      callbacks.insert(
-        CallbackMap::value_type(strdup(longKey),
-          CallbackContainer(callback, data)));
+      writableSchema()->registerCallback(id, callback, data);
     } else
     {
       // longKey does not exist
@@ -467,118 +744,335 @@ void ArgumentParserInternals::registerCallback(const char *longKey,
     }
   } else
   {
-    callbacks.insert(
-      CallbackMap::value_type(strdup(""), CallbackContainer(callback, data)));
+    writableSchema()->registerStandaloneCallback(callback, data);
   }
 }
 
-void ArgumentParserInternals::Standalones(int maximum, const char *helpKey,
-  const char *comment)
+void ArgumentParserInternals::registerCallbackOrder(const char *before,
+  const char *after)
 {
-  if (standalones.size() != 0)
+  unsigned int beforeId = before ? fetchId(before) : noId;
+  unsigned int afterId = after ? fetchId(after) : noId;
+  if (beforeId == noId || afterId == noId)
   {
-#ifdef DEBUG
-    cerr
-    << "can't change maximum number of standalone arguments: arguments have already been read"
-    << endl;
-#endif
+    const char *unknown = beforeId == noId ? before : after;
+    cerr << "registerCallbackOrder: unknown key '"
+      << (unknown ? unknown : "NULL") << "'" << endl;
     return;
-    //    throw runtime_error(
-    //        "can't change maximum number of standalone arguments: arguments have already been read");
   }
 
-  if (maximum < 0)
+  if (!writableSchema()->registerCallbackOrder(beforeId, afterId))
   {
-    maxStandalones = -1;
-  } else
-  {
-    maxStandalones = maximum;
+    cerr << "registerCallbackOrder: '" << before << "' before '" << after
+      << "' contradicts the registered order" << endl;
   }
+}
 
-  if (standaloneHelpKey)
-  {
-    free(standaloneHelpKey);
-    standaloneHelpKey = NULL;
-  }
-  if (helpKey != NULL)
+void ArgumentParserInternals::addSubcommand(ArgumentParser *parser,
+  const char *name, SubcommandInit init, void *data, const char *comment)
+{
+  if (name == NULL || !validateKey(name) || init == NULL)
   {
-    // THIS is not ideal
-    standaloneHelpKey = strdup(helpKey);
+    cerr << "addSubcommand: invalid sub-command '" << (name ? name : "NULL")
+      << "'" << endl;
+    return;
   }
 
-  if (standaloneComment)
-  {
-    free(standaloneComment);
-    standaloneComment = NULL;
-  }
-  if (comment)
+  if (findSubcommand(name) != noId)
   {
-    standaloneComment = strdup(comment);
+    cerr << "addSubcommand: '" << name << "' already exists" << endl;
+    return;
   }
 
+  Subcommand entry;
+  entry.name = strdup(name);
+  entry.comment = comment ? strdup(comment) : NULL;
+  entry.init = init;
+  entry.data = data;
+  entry.parser = parser;
+  subcommands.push_back(entry);
 }
 
-void ArgumentParserInternals::File(const char *longKey, const char *comment,
-  unsigned char shortKey)
+const char *ArgumentParserInternals::getSubcommand()
 {
-  if (longKey == NULL)
-    return;
-
-  registerArgument(longKey, Argument::noType);
-  registerShortKey(shortKey, longKey);
-  registerComment(longKey, comment);
+  return subcommand == noId ? NULL : subcommands[subcommand].name;
 }
 
-void ArgumentParserInternals::registerShortKey(unsigned char shortKey,
-  const char *longKey)
+unsigned int ArgumentParserInternals::findSubcommand(const char *name)
 {
-  if (isgraph(shortKey))
+  // only the first standalone of a parser can be a sub-command
+  if (subcommand != noId || subcommands.empty()
+    || values.getStandaloneCount() != 0)
   {
-    if (shortKeys[shortKey] == NULL)
-    {
-      clearShortKey(shortKey);
-      if (longKey != NULL)
-      {
-        shortKeys[shortKey] = strdup(longKey);
-      }
-    } else
+    return noId;
+  }
+
+  for (unsigned int index = 0; index < subcommands.size(); ++index)
+  {
+    if (strcmp(subcommands[index].name, name) == 0)
     {
-      cerr << "shortkey -" << shortKey << " is already registered as --"
-        << shortKeys[shortKey] << endl;
+      return index;
     }
   }
-}
 
-bool ArgumentParserInternals::keyExists(const char *longKey)
-{
-  return (fetchArgument(longKey)) != NULL;
+  return noId;
 }
 
-bool ArgumentParserInternals::wasValueSet(const char *longKey,
-  bool includeDefault)
+bool ArgumentParserInternals::isBoolKey(const char *longKey)
 {
-  Argument *argument = fetchArgument(longKey, includeDefault);
-  if (argument == NULL)
-  {
-    return false;
-  }
-
-  return argument->wasSet();
+  unsigned int id = fetchId(longKey);
+  return id != noId && schema->getOption(id).type == Argument::boolType;
 }
 
-bool ArgumentParserInternals::shortKeyExists(unsigned char shortKey)
+void ArgumentParserInternals::selectSubcommand(unsigned int index)
 {
-  return (shortKeys[shortKey] != NULL);
+  subcommand = index;
+  subcommandFirstId = schema->size();
+
+  // the options are registered now, parsing continues with them
+  const Subcommand &entry = subcommands[index];
+  entry.init(*entry.parser, entry.data);
 }
 
-const char *ArgumentParserInternals::getLongKey(unsigned char shortKey)
+void ArgumentParserInternals::Standalones(int maximum, const char *helpKey,
+  const char *comment)
 {
-  if (shortKeys[shortKey] == NULL)
+  if (values.getStandaloneCount() != 0)
   {
-    cerr << "'" << shortKey << "' is no valid shortkey" << endl;
-    return NULL;
+#ifdef DEBUG
+    cerr
+    << "can't change maximum number of standalone arguments: arguments have already been read"
+    << endl;
+#endif
+    return;
+    //    throw runtime_error(
+    //        "can't change maximum number of standalone arguments: arguments have already been read");
+  }
+
+  writableSchema()->registerStandalones(maximum, helpKey, comment);
+}
+
+void ArgumentParserInternals::File(const char *longKey, const char *comment,
+  unsigned char shortKey)
+{
+  if (longKey == NULL)
+    return;
+
+  registerArgument(longKey, Argument::noType);
+  registerShortKey(shortKey, longKey);
+  registerComment(longKey, comment);
+}
+
+void ArgumentParserInternals::bindStruct(void *base,
+  const ArgumentParser::Field *fields, size_t count)
+{
+  if (base == NULL)
+  {
+    return;
+  }
+
+  Binding binding;
+  binding.base = static_cast<const char*>(base);
+
+  for (const ArgumentParser::Field *field = fields; field != fields + count;
+    ++field)
+  {
+    void *target = static_cast<char*>(base) + field->offset;
+    switch (field->type)
+    {
+    case ArgumentParser::Event::boolType:
+      Bool(field->longKey, *static_cast<bool*>(target), field->comment,
+        field->shortKey, static_cast<bool*>(target));
+      break;
+    case ArgumentParser::Event::intType:
+      Int(field->longKey, *static_cast<int*>(target), field->comment,
+        field->shortKey, static_cast<int*>(target));
+      break;
+    case ArgumentParser::Event::uintType:
+      UInt(field->longKey, *static_cast<unsigned int*>(target), field->comment,
+        field->shortKey, static_cast<unsigned int*>(target));
+      break;
+    case ArgumentParser::Event::doubleType:
+      Double(field->longKey, *static_cast<double*>(target), field->comment,
+        field->shortKey, static_cast<double*>(target));
+      break;
+    case ArgumentParser::Event::stringType:
+    {
+      // the field changes, so its default has to be copied
+      String(field->longKey, field->comment, field->shortKey, NULL);
+      bool isStatic = staticStrings;
+      staticStrings = false;
+      String(field->longKey, static_cast<char*>(target), NULL, '\0', NULL);
+      staticStrings = isStatic;
+
+      unsigned int id = fetchId(field->longKey);
+      if (id != noId)
+      {
+        writableSchema()->registerTarget(id, target, Argument::noType,
+          memory_order_relaxed, field->size);
+      }
+      break;
+    }
+    case ArgumentParser::Event::noType:
+      cerr << "bindStruct: field '" << field->longKey << "' has no type"
+        << endl;
+      continue;
+    }
+
+    unsigned int id = fetchId(field->longKey);
+    if (id == noId)
+    {
+      cerr << "bindStruct: invalid key '" << field->longKey << "'" << endl;
+      continue;
+    }
+
+    BoundField bound = { id, field->type, field->offset };
+    binding.fields.push_back(bound);
+  }
+
+  bindings.push_back(binding);
+}
+
+bool ArgumentParserInternals::writeStruct(const char *filename,
+  const void *base)
+{
+  const Binding *binding = NULL;
+  for (BindingVector::const_iterator it = bindings.begin();
+    it != bindings.end(); ++it)
+  {
+    if (it->base == base)
+    {
+      binding = &*it;
+    }
+  }
+
+  if (binding == NULL)
+  {
+    cerr << "writeStruct: the struct isn't bound" << endl;
+    return true;
+  }
+
+  ofstream file(filename);
+  if (!file.is_open())
+  {
+    cerr << "can't open file '" << filename << "' for writing" << endl;
+    return true;
+  }
+
+  // 17 digits, so every double reads back into the same value
+  file.precision(17);
+  for (vector<BoundField>::const_iterator it = binding->fields.begin();
+    it != binding->fields.end(); ++it)
+  {
+    const char *field = binding->base + it->offset;
+    file << schema->getOption(it->id).longKey << " = ";
+    switch (it->type)
+    {
+    case ArgumentParser::Event::boolType:
+      file << (*reinterpret_cast<const bool*>(field) ? "true" : "false");
+      break;
+    case ArgumentParser::Event::intType:
+      file << *reinterpret_cast<const int*>(field);
+      break;
+    case ArgumentParser::Event::uintType:
+      file << *reinterpret_cast<const unsigned int*>(field);
+      break;
+    case ArgumentParser::Event::doubleType:
+      file << *reinterpret_cast<const double*>(field);
+      break;
+    case ArgumentParser::Event::stringType:
+      file << field;
+      break;
+    case ArgumentParser::Event::noType:
+      break;
+    }
+    file << endl;
+  }
+
+  file.close();
+
+  return false;
+}
+
+void ArgumentParserInternals::registerShortKey(unsigned char shortKey,
+  const char *longKey)
+{
+  unsigned int id = fetchId(longKey);
+  if (id != noId && isgraph(shortKey) && schema->fetchShortKey(shortKey) != id)
+  {
+    writableSchema()->registerShortKey(shortKey, id);
+  }
+}
+
+bool ArgumentParserInternals::keyExists(const char *longKey)
+{
+  return fetchId(longKey) != noId;
+}
+
+bool ArgumentParserInternals::wasValueSet(const char *longKey,
+  bool includeDefault)
+{
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+  {
+    return false;
+  }
+
+  return setKeys.test(id)
+    || (includeDefault && schema->getDefaultKeys().test(id));
+}
+
+ArgumentParserInternals::Layer ArgumentParserInternals::getLayer(
+  const char *longKey)
+{
+  unsigned int id = fetchId(longKey);
+  if (id == noId)
+  {
+    return ArgumentParser::defaultLayer;
+  }
+
+  return values.getLayer(id);
+}
+
+void ArgumentParserInternals::clearLayer(Layer clearedLayer)
+{
+  if (clearedLayer <= ArgumentParser::defaultLayer
+    || clearedLayer > ArgumentParser::runtimeLayer)
+  {
+    cerr << "clearLayer: the defaults can't be cleared" << endl;
+    return;
+  }
+
+  values.clearLayer(clearedLayer, changedKeys);
+
+  Layer outerLayer = layer;
+  layer = clearedLayer;
+
+  beginCallbacks();
+  for (size_t id = changedKeys.findNext(0); id != Bitset::npos;
+    id = changedKeys.findNext(id + 1))
+  {
+    commitKey(id);
+  }
+  endCallbacks();
+
+  layer = outerLayer;
+}
+
+bool ArgumentParserInternals::shortKeyExists(unsigned char shortKey)
+{
+  return (schema->fetchShortKey(shortKey) != noId);
+}
+
+const char *ArgumentParserInternals::getLongKey(unsigned char shortKey)
+{
+  unsigned int id = schema->fetchShortKey(shortKey);
+  if (id == noId)
+  {
+    cerr << "'" << shortKey << "' is no valid shortkey" << endl;
+    return NULL;
   }
-  return shortKeys[shortKey];
+  return schema->getOption(id).longKey;
 }
 
 void ArgumentParserInternals::getLongKey(unsigned char shortKey, char *output)
@@ -590,7 +1084,7 @@ void ArgumentParserInternals::getLongKey(unsigned char shortKey, char *output)
 
   if (shortKeyExists(shortKey))
   {
-    strcpy(output, shortKeys[shortKey]);
+    strcpy(output, getLongKey(shortKey));
   } else
   {
     output[0] = '\0';
@@ -599,19 +1093,102 @@ void ArgumentParserInternals::getLongKey(unsigned char shortKey, char *output)
 
 bool ArgumentParserInternals::allValuesSet(const char *errorFormat)
 {
-  bool retval = true;
-  for (ArgumentMap::iterator it = arguments.begin(); it != arguments.end();
-    ++it)
+  const Bitset &requiredKeys = schema->getRequiredKeys();
+  if (requiredKeys.isSubsetOf(setKeys))
+  {
+    return true;
+  }
+
+  if (errorFormat != NULL)
   {
-    if (!wasValueSet(it->first, true) && !it->second.hasType(Argument::noType))
+    const Schema::KeyMap &keys = schema->getKeys();
+    for (Schema::KeyMap::const_iterator it = keys.begin(); it != keys.end();
+      ++it)
     {
-      if (errorFormat == NULL)
-      {
-        return false;
-      } else
+      if (requiredKeys.test(it->second) && !setKeys.test(it->second))
       {
         fprintf(stderr, errorFormat, it->first);
-        retval = false;
+      }
+    }
+  }
+
+  return false;
+}
+
+void ArgumentParserInternals::registerRequirement(const char *longKey,
+  const char *requiredKey)
+{
+  unsigned int id = fetchId(longKey);
+  unsigned int requiredId = fetchId(requiredKey);
+  if (id == noId || requiredId == noId)
+  {
+    const char *unknown = id == noId ? longKey : requiredKey;
+    cerr << "registerRequirement: unknown key '" << (unknown ? unknown : "NULL")
+      << "'" << endl;
+    return;
+  }
+
+  writableSchema()->registerRequirement(id, requiredId);
+}
+
+void ArgumentParserInternals::registerConflict(const char *longKey,
+  const char *conflictingKey)
+{
+  unsigned int id = fetchId(longKey);
+  unsigned int conflictingId = fetchId(conflictingKey);
+  if (id == noId || conflictingId == noId)
+  {
+    const char *unknown = id == noId ? longKey : conflictingKey;
+    cerr << "registerConflict: unknown key '" << (unknown ? unknown : "NULL")
+      << "'" << endl;
+    return;
+  }
+
+  writableSchema()->registerConflict(id, conflictingId);
+}
+
+bool ArgumentParserInternals::checkConstraints(bool verbose)
+{
+  presentKeys = setKeys;
+  presentKeys |= schema->getDefaultKeys();
+
+  bool retval = true;
+  const Bitset &constrainedKeys = schema->getConstrainedKeys();
+  for (size_t id = constrainedKeys.findNext(0); id != Bitset::npos;
+    id = constrainedKeys.findNext(id + 1))
+  {
+    const Schema::Option &option = schema->getOption(id);
+    const Bitset &requirements = option.getLinks().requirements;
+    const Bitset &conflicts = option.getLinks().conflicts;
+    if (!setKeys.test(id)
+      || (requirements.isSubsetOf(presentKeys)
+        && !conflicts.intersects(setKeys)))
+    {
+      continue;
+    }
+
+    retval = false;
+    if (!verbose)
+    {
+      break;
+    }
+
+    for (size_t other = requirements.findNext(0); other != Bitset::npos;
+      other = requirements.findNext(other + 1))
+    {
+      if (!presentKeys.test(other))
+      {
+        cerr << "--" << option.longKey << " requires --"
+          << schema->getOption(other).longKey << endl;
+      }
+    }
+    for (size_t other = conflicts.findNext(0); other != Bitset::npos;
+      other = conflicts.findNext(other + 1))
+    {
+      if (setKeys.test(other))
+      {
+        cerr << "--" << option.longKey << " conflicts with --"
+          << schema->getOption(other).longKey << endl;
       }
     }
   }
@@ -718,7 +1295,7 @@ const char *ArgumentParserInternals::getCString(const char *longKey)
 
 int ArgumentParserInternals::getStandaloneCount()
 {
-  return standalones.size();
+  return values.getStandaloneCount();
 }
 
 void ArgumentParserInternals::getStandalone(unsigned int index, char *output)
@@ -750,109 +1327,149 @@ const char *ArgumentParserInternals::getCStandalone(unsigned int index)
       cerr << "getCStandalone: list of standalones is empty" << endl;
       return NULL;
     }
-    return standalones[getStandaloneCount() - 1];
-  } else if (index >= getStandaloneCount())
+    return values.getStandalone(getStandaloneCount() - 1);
+  } else if (index >= values.getStandaloneCount())
   {
     cerr << "getCStandalone: invalid index" << endl;
     return NULL;
     //    throw runtime_error("getCStandalone: invalid index");
   }
 
-  return standalones[index];
+  return values.getStandalone(index);
+}
+
+void ArgumentParserInternals::reserveStandalones(size_t count, size_t bytes)
+{
+  values.reserveStandalones(count, bytes);
+}
+
+size_t ArgumentParserInternals::getStandaloneData(const char **data,
+  const size_t **offsets)
+{
+  return values.getStandaloneData(data, offsets);
 }
 
 void ArgumentParserInternals::set(const char *longKey, bool value)
 {
-  Argument *argument = fetchArgument(longKey);
+  unsigned int id = fetchId(longKey);
 
-  if (argument == NULL)
+  if (id == noId)
   {
     cerr << "'" << longKey << "' is no valid argument" << endl;
     return;
   }
 
-  argument->set(value);
+  values.set(id, layer, value);
 
-  setTargets(longKey);
-
-  fireCallbacks(longKey);
+  commitKey(id);
 }
 
 void ArgumentParserInternals::set(const char *longKey, int value)
 {
-  Argument *argument = fetchArgument(longKey);
+  unsigned int id = fetchId(longKey);
 
-  if (argument == NULL)
+  if (id == noId)
   {
     cerr << "'" << longKey << "' is no valid argument" << endl;
     return;
   }
 
-  argument->set(value);
+  values.set(id, layer, value);
 
-  setTargets(longKey);
-
-  fireCallbacks(longKey);
+  commitKey(id);
 }
 
 void ArgumentParserInternals::set(const char *longKey, unsigned int value)
 {
-  Argument *argument = fetchArgument(longKey);
+  unsigned int id = fetchId(longKey);
 
-  if (argument == NULL)
+  if (id == noId)
   {
     cerr << "'" << longKey << "' is no valid argument" << endl;
     return;
   }
 
-  argument->set(value);
+  values.set(id, layer, value);
 
-  setTargets(longKey);
-
-  fireCallbacks(longKey);
+  commitKey(id);
 }
 
 void ArgumentParserInternals::set(const char *longKey, double value)
 {
-  Argument *argument = fetchArgument(longKey);
+  unsigned int id = fetchId(longKey);
 
-  if (argument == NULL)
+  if (id == noId)
   {
     cerr << "'" << longKey << "' is no valid argument" << endl;
     return;
   }
 
-  argument->set(value);
+  values.set(id, layer, value);
 
-  setTargets(longKey);
+  commitKey(id);
+}
 
-  fireCallbacks(longKey);
+#ifdef ARGUMENTPARSER_STATS
+static void countConversion(ParseStats &stats, Argument::ValueType type)
+{
+  switch (type)
+  {
+  case Argument::noType:
+    break;
+  case Argument::boolType:
+    ++stats.boolConversions;
+    break;
+  case Argument::intType:
+    ++stats.intConversions;
+    break;
+  case Argument::uintType:
+    ++stats.uintConversions;
+    break;
+  case Argument::doubleType:
+    ++stats.doubleConversions;
+    break;
+  case Argument::stringType:
+    ++stats.stringConversions;
+    break;
+  }
 }
+#endif
 
 void ArgumentParserInternals::set(const char *longKey, const char *value)
 {
-  Argument *argument = fetchArgument(longKey);
+  STATS_SCOPE(&stats);
+  unsigned int id = fetchId(longKey);
 
-  if (argument == NULL)
+  if (id == noId)
   {
     cerr << "'" << longKey << "' is no valid argument" << endl;
     return;
   }
 
-  if (argument->getType() == Argument::noType)
+  set(id, value);
+}
+
+void ArgumentParserInternals::set(unsigned int id, const char *value)
+{
+  STATS_SCOPE(&stats);
+
+  if (values[id].getType() == Argument::noType)
   {
-    parseFile(value);
+    parseFile(value, layer);
   } else
   {
-    argument->set(value);
+    STATS_TIMER(conversionTime);
+#ifdef ARGUMENTPARSER_STATS
+    countConversion(stats, values[id].getType());
+#endif
+    values.set(id, layer, value);
   }
 
-  setTargets(longKey);
-
 #ifdef DEBUG
-  cout << "fireCallbacks for key '" << longKey << "'" << endl;
+  cout << "fireCallbacks for key '" << schema->getOption(id).longKey << "'"
+    << endl;
 #endif
-  fireCallbacks(longKey);
+  commitKey(id);
 }
 
 void ArgumentParserInternals::setTarget(Argument *argument, void *target)
@@ -884,182 +1501,533 @@ void ArgumentParserInternals::setTarget(Argument *argument, void *target)
   }
 }
 
-void ArgumentParserInternals::setTargets(const char *longKey)
+void ArgumentParserInternals::setTarget(Argument *argument,
+  const Schema::Target &target)
 {
-  Argument *argument = fetchArgument(longKey, true);
+  switch (target.atomicType)
+  {
+  case Argument::noType:
+    if (target.size != 0 && argument->hasType(Argument::stringType))
+    {
+      // bounded, e.g. a char array of a bound struct
+      char *field = reinterpret_cast<char*>(target.pointer);
+      strncpy(field, argument->getString(), target.size - 1);
+      field[target.size - 1] = '\0';
+    } else
+    {
+      setTarget(argument, target.pointer);
+    }
+    break;
+  case Argument::boolType:
+    reinterpret_cast<atomic<bool>*>(target.pointer)->store(
+      argument->getBool(), target.order);
+    break;
+  case Argument::intType:
+    reinterpret_cast<atomic<int>*>(target.pointer)->store(argument->getInt(),
+      target.order);
+    break;
+  case Argument::uintType:
+    reinterpret_cast<atomic<unsigned int>*>(target.pointer)->store(
+      argument->getUInt(), target.order);
+    break;
+  case Argument::doubleType:
+    reinterpret_cast<atomic<double>*>(target.pointer)->store(
+      argument->getDouble(), target.order);
+    break;
+  case Argument::stringType:
+    // there are no atomic strings
+    break;
+  }
+}
 
-  if (argument == NULL)
+void ArgumentParserInternals::setTargets(unsigned int id)
+{
+  const Schema::TargetVector &targets =
+    schema->getOption(id).getLinks().targets;
+
+  if (targets.empty())
   {
     return;
   }
 
-  TargetRange range = targets.equal_range(longKey);
+  STATS_SCOPE(&stats);
+  STATS_ADD(targetsWritten, targets.size());
+  Argument *argument = fetchArgument(id, true);
 
-  for (TargetMap::iterator it = range.first; it != range.second; ++it)
+  for (Schema::TargetVector::const_iterator it = targets.begin();
+    it != targets.end(); ++it)
   {
-    setTarget(argument, it->second);
+    setTarget(argument, *it);
   }
 }
 
 void ArgumentParserInternals::setAllTargets()
 {
-  for (TargetMap::iterator it = targets.begin(); it != targets.end(); ++it)
+  for (unsigned int id = 0; id < schema->size(); ++id)
   {
-    setTarget(fetchArgument(it->first, true), it->second);
+    setTargets(id);
   }
 }
 
-void ArgumentParserInternals::setProgName(const char *_progname)
+void ArgumentParserInternals::updateValueTable(bool updateAll)
 {
-  free(progname);
-
-  if (progname == NULL)
+  // allocated by the first getValueTable()
+  if (valueTable.empty())
   {
-    progname = strdup("NULL");
-  } else
+    return;
+  }
+
+  unsigned int size = updateAll ? 0 : valueTable.size() - 1;
+  valueTable.resize(schema->size() + 1);
+  valueCells = &valueTable[0] + 1;
+
+  for (unsigned int id = size; id < schema->size(); ++id)
   {
-    progname = strdup(_progname);
+    updateValueCell(id);
   }
 }
 
-void ArgumentParserInternals::parseFile(const char *filename)
+void ArgumentParserInternals::updateValueCell(unsigned int id)
 {
-  ifstream file(filename);
-  if (!file.is_open())
+  if (valueCells == NULL)
   {
-    cerr << "can't open file " << filename << endl;
     return;
   }
 
-  char lineBuffer[1024];
-  while (!file.eof())
+  ArgumentValue &cell = valueCells[id];
+  memset(&cell, 0, sizeof(cell));
+
+  Argument *argument = fetchArgument(id, true);
+  cell.type = argument->getType();
+  cell.layer = values.getLayer(id);
+  if (!argument->wasSet())
   {
-    file.getline(lineBuffer, 1024);
-    parseLine(lineBuffer);
+    return;
   }
 
-  file.close();
-
-  lookForHelp();
+  cell.isSet = 1;
+  switch (argument->getType())
+  {
+  case Argument::boolType:
+    cell.value.boolValue = argument->getBool();
+    break;
+  case Argument::intType:
+    cell.value.intValue = argument->getInt();
+    break;
+  case Argument::uintType:
+    cell.value.uintValue = argument->getUInt();
+    break;
+  case Argument::doubleType:
+    cell.value.doubleValue = argument->getDouble();
+    break;
+  case Argument::stringType:
+    cell.value.stringValue = argument->getString();
+    break;
+  case Argument::noType:
+    break;
+  }
 }
 
-void ArgumentParserInternals::parseLine(const char *line)
+void ArgumentParserInternals::commitKey(unsigned int id)
 {
-// line format (regex): /^\s*\([a-zA-Z0-9]*\)\s*=\s*\(\S*\)\s*$/
+  updateValueCell(id);
 
-  if (line == NULL || line[0] == '\0')
+  if (values.isSet(id))
   {
-    return;
+    setKeys.set(id);
+  } else
+  {
+    setKeys.reset(id);
   }
 
-  const char *keyStart = line;
-// strip leading blanks
-  while (isblank(*keyStart))
+  // an upper layer still overrides the value
+  if (values.getLayer(id) > layer)
   {
-    ++keyStart;
+    return;
   }
 
-// abort on \0 or !alnum
-  if (!isalnum(*keyStart))
+  if (batchDepth > 0)
   {
-    switch (keyStart[0])
+    dirtyKeys.set(id);
+    // clones allocate them on their first batch
+    if (id >= dirtySources.size())
     {
-    case '\0':
-    case '%':
-    case '#':
-    case '"':
-    case '/':
-    case '!':
-      break;
-    default:
-      cerr << "ArgumentParser::parseLine:"
-        << " unexpected character at beginning of line '" << line << "'"
-        << endl;
-      return;
+      dirtySources.resize(schema->size());
     }
+    dirtySources[id] = source;
     return;
   }
 
-  const char *keyEnd = keyStart;
-// find end of key
-  while (isalnum(*keyEnd))
+  setTargets(id);
+  fireCallbacks(id, source);
+}
+
+void ArgumentParserInternals::commitStandalones()
+{
+  if (batchDepth > 0)
   {
-    ++keyEnd;
+    dirtyStandalones = true;
+    standaloneSource = source;
+    return;
+  }
+
+  fireStandaloneCallbacks(source);
+}
+
+void ArgumentParserInternals::setBatchMode(bool batch)
+{
+  batchParsing = batch;
+}
+
+void ArgumentParserInternals::beginBatch()
+{
+  ++batchDepth;
+}
+
+void ArgumentParserInternals::commitBatch()
+{
+  if (batchDepth == 0 || --batchDepth > 0)
+  {
+    return;
   }
 
-// strip blanks in front of '='
-  const char *ptr = keyEnd;
-  while (isblank(*ptr))
+  beginCallbacks();
+
+  // callbacks may set further values, which are then committed immediately
+  for (size_t id = dirtyKeys.findNext(0); id != Bitset::npos;
+    id = dirtyKeys.findNext(id + 1))
+  {
+    dirtyKeys.reset(id);
+    setTargets(id);
+    fireCallbacks(id, dirtySources[id]);
+  }
+
+  if (dirtyStandalones)
   {
-    ++ptr;
+    dirtyStandalones = false;
+    fireStandaloneCallbacks(standaloneSource);
   }
 
-// validate existing '='
-  if (*ptr != '=')
+  endCallbacks();
+}
+
+void ArgumentParserInternals::beginCallbacks()
+{
+  ++callbackDepth;
+}
+
+void ArgumentParserInternals::endCallbacks()
+{
+  if (--callbackDepth > 0 || scheduler == NULL)
   {
-    //    cerr << "ArgumentParser::parseLine: missing '=' in line '" << line << "'"
-    //        << endl;
     return;
   }
 
-  const char *valueStart = ptr + 1;
-// strip blanks in front of value
-  while (isblank(*valueStart))
+  scheduler->release(*schema);
+  if (waitForCallbacksAtEnd)
   {
-    ++valueStart;
+    scheduler->wait();
   }
+}
 
-// validate valid value
-  if (!isprint(*valueStart))
+void ArgumentParserInternals::setAsyncCallbacks(unsigned int threads,
+  bool waitAtEnd)
+{
+  if (callbackDepth > 0)
   {
-    //    cerr
-    //        << "ArgumentParser::parseLine: missing value or unexpected symbol in line '"
-    //        << line << "'" << endl;
+    cerr << "setAsyncCallbacks: can't be changed while parsing" << endl;
     return;
   }
 
-// search for unexpected symbols in value
-  const char *valueEnd = valueStart;
-  while (isprint(*valueEnd))
+  // waits for the pending callbacks
+  delete scheduler;
+  scheduler = NULL;
+
+  if (threads > 0)
+  {
+    scheduler = new CallbackScheduler(threads);
+  }
+  waitForCallbacksAtEnd = waitAtEnd;
+}
+
+void ArgumentParserInternals::waitForCallbacks()
+{
+  if (scheduler)
+  {
+    scheduler->wait();
+  }
+}
+
+bool ArgumentParserInternals::callbacksDone()
+{
+  return scheduler == NULL || scheduler->done();
+}
+
+void ArgumentParserInternals::setProgName(const char *_progname)
+{
+  free(progname);
+
+  if (progname == NULL)
+  {
+    progname = strdup("NULL");
+  } else
   {
-    ++valueEnd;
+    progname = strdup(_progname);
   }
-// if everything's correct, we're at the end of the string
-  if (*valueEnd != '\0')
+}
+
+void ArgumentParserInternals::parseFile(const char *filename, Layer fileLayer)
+{
+  parseFiles(&filename, 1, fileLayer);
+}
+
+// reads and splits the files on up to one thread per core
+static void loadFiles(vector<ConfigFile> &files, const char * const *filenames,
+  const Schema &schema)
+{
+  size_t count = files.size();
+  size_t threadCount = thread::hardware_concurrency();
+  if (threadCount == 0)
+  {
+    threadCount = 1;
+  }
+  if (threadCount > count)
+  {
+    threadCount = count;
+  }
+
+  atomic<size_t> next(0);
+  auto load = [&files, filenames, &schema, count, &next]()
+  {
+    for (size_t i; (i = next.fetch_add(1, memory_order_relaxed)) < count;)
+    {
+      files[i].load(filenames[i], schema);
+    }
+  };
+
+  vector<thread> threads;
+  for (size_t i = 1; i < threadCount; ++i)
+  {
+    threads.push_back(thread(load));
+  }
+  load();
+
+  for (vector<thread>::iterator it = threads.begin(); it != threads.end();
+    ++it)
+  {
+    it->join();
+  }
+}
+
+void ArgumentParserInternals::parseFiles(const char * const *filenames,
+  size_t count, Layer fileLayer)
+{
+  if (filenames == NULL || count == 0)
   {
-    //    cerr << "ArgumentParser::parseLine: unexpected symbol in value of line '"
-    //        << line << "'" << endl;
     return;
   }
 
-// strip trailing blanks
-  --valueEnd;
-  while (isblank(*valueEnd))
+  STATS_SCOPE(&stats);
+  STATS_TIMER(tokenizingTime);
+
+  // parsing doesn't change the schema, so the keys can be looked up in parallel
+  vector<ConfigFile> files(count);
+  loadFiles(files, filenames, *schema);
+
+  Layer outerLayer = layer;
+  layer = fileLayer;
+
+  beginCallbacks();
+  for (size_t i = 0; i < count; ++i)
   {
-    --valueEnd;
+    applyFile(files[i], filenames[i]);
   }
+  endCallbacks();
+
+  layer = outerLayer;
+
+  lookForHelp();
+}
 
-  ++valueEnd;
-  if (valueEnd <= valueStart)
+void ArgumentParserInternals::applyFile(const ConfigFile &file,
+  const char *filename)
+{
+  if (!file.isOpen())
   {
+    cerr << "can't open file " << filename << endl;
+    return;
+  }
+
+  ++includeDepth;
+  STATS_MAX(maxIncludeDepth, includeDepth);
+  STATS_ADD(linesParsed, file.getLineCount());
+
+  Source outerSource = source;
+  source.file = storeFileName(filename);
+
+  if (batchParsing)
+  {
+    beginBatch();
+  }
+
+  // included files are parsed in place by set()
+  const ConfigFile::EntryVector &entries = file.getEntries();
+  for (ConfigFile::EntryVector::const_iterator it = entries.begin();
+    it != entries.end(); ++it)
+  {
+    source.line = it->line;
+    if (it->type != assignmentLine)
+    {
+      reportLine(it->type, it->text);
+    } else if (it->id == noId)
+    {
+      cerr << "'";
+      if (it->section != NULL)
+      {
+        cerr << it->section << '.';
+      }
+      cerr << it->key << "' is no valid argument" << endl;
+    } else
+    {
+      set(it->id, it->value);
+    }
+  }
+
+  --includeDepth;
+  source = outerSource;
+
+  if (batchParsing)
+  {
+    commitBatch();
+  }
+}
+
+void ArgumentParserInternals::reportLine(LineType type, const char *line)
+{
+  switch (type)
+  {
+  case unexpectedCharacterLine:
+    cerr << "ArgumentParser::parseLine:"
+      << " unexpected character at beginning of line '" << line << "'"
+      << endl;
+    break;
+  case syntaxErrorLine:
     cerr << "syntax error in line '" << line << "'" << endl;
+    break;
+  case ignoredLine:
+  case assignmentLine:
+  case sectionLine:
+    break;
+  }
+}
+
+void ArgumentParserInternals::parseLine(const char *line, Layer lineLayer)
+{
+  if (line == NULL || line[0] == '\0')
+  {
     return;
   }
 
-  char longKey[1024];
-  memset(longKey, '\0', sizeof(longKey));
-  memcpy(longKey, keyStart, keyEnd - keyStart);
+  STATS_SCOPE(&stats);
+  STATS_TIMER(tokenizingTime);
+  STATS_ADD(linesParsed, 1);
 
+  const char *keyStart;
+  const char *keyEnd;
+  const char *valueStart;
+  const char *valueEnd;
+  LineType type = splitLine(line, &keyStart, &keyEnd, &valueStart, &valueEnd);
+  if (type == sectionLine)
+  {
+    // the keys of the following lines are in the section
+    lineSection.assign(keyStart, keyEnd);
+    lineSection.push_back('\0');
+    return;
+  }
+  if (type != assignmentLine)
+  {
+    reportLine(type, line);
+    return;
+  }
+
+  char longKey[ConfigFile::maxKeyLength];
   char value[1024];
-  memset(value, '\0', sizeof(value));
+  if (!ConfigFile::joinKey(lineSection.empty() ? NULL : &lineSection[0],
+    keyStart, keyEnd - keyStart, longKey)
+    || size_t(valueEnd - valueStart) >= sizeof(value))
+  {
+    cerr << "line too long: '" << line << "'" << endl;
+    return;
+  }
   memcpy(value, valueStart, valueEnd - valueStart);
+  value[valueEnd - valueStart] = '\0';
+
+  Layer outerLayer = layer;
+  layer = lineLayer;
+
+  beginCallbacks();
+  if (batchParsing)
+  {
+    beginBatch();
+  }
 
   set(longKey, value);
 
+  if (batchParsing)
+  {
+    commitBatch();
+  }
+  endCallbacks();
+
+  layer = outerLayer;
+
   lookForHelp();
 }
 
 void ArgumentParserInternals::parseArgs(int argc, char **argv)
+{
+  // a completion query without an index is answered from the registered
+  // keys, still before anything is parsed
+  if (isCompletionQuery(argc, argv) && fetchId("complete") == noId)
+  {
+    CompletionIndex::Buffer buffer;
+    buildCompletionIndex(buffer);
+
+    CompletionIndex index;
+    index.open(&buffer[0], buffer.size());
+    index.complete(argv + 2, argc - 2, cout);
+    cout.flush();
+    exit(0);
+  }
+
+  STATS_SCOPE(&stats);
+  STATS_TIMER(tokenizingTime);
+
+  Source outerSource = source;
+  Layer outerLayer = layer;
+  layer = ArgumentParser::argvLayer;
+
+  beginCallbacks();
+  if (batchParsing)
+  {
+    beginBatch();
+  }
+
+  parseArgv(argc, argv);
+
+  if (batchParsing)
+  {
+    commitBatch();
+  }
+  endCallbacks();
+
+  source = outerSource;
+  layer = outerLayer;
+
+  lookForHelp();
+}
+
+void ArgumentParserInternals::parseArgv(int argc, char **argv)
 {
   const char *lastKey = NULL; // always a long key or NULL
 
@@ -1084,96 +2052,432 @@ void ArgumentParserInternals::parseArgs(int argc, char **argv)
 #ifdef DEBUG
     cout << "parsing argument #" << i << ": '" << argv[i] << "'" << endl;
 #endif
-    if (argv[i][0] != '-')
+    source.argIndex = i;
+    if (parseArgument(argv[i], lastKey, 0))
     {
-      // this is a value
-      if (lastKey == NULL)
-      {
+      return;
+    }
+  }
+
+  if (lastKey != NULL)
+  {
 #ifdef DEBUG
-        cout << "adding standalone argument"<< endl;
+    cout << "setting last key to true" << endl;
 #endif
 
-        addStandalone(argv[i]);
+    setPendingKey(lastKey, NULL);
+  }
+
+#ifdef DEBUG
+  cout << "done parsing"<< endl;
+#endif
+}
+
+void ArgumentParserInternals::parseCommandString(const char *command,
+  size_t length)
+{
+  if (command == NULL)
+  {
+    return;
+  }
+
+  STATS_SCOPE(&stats);
+  STATS_TIMER(tokenizingTime);
+
+  // take the scratch buffer, so callbacks may parse further command strings
+  CommandBuffer buffer;
+  buffer.swap(commandBuffer);
+  buffer.assign(command, command + length);
+  buffer.push_back('\0');
+
+  beginCallbacks();
+  if (batchParsing)
+  {
+    beginBatch();
+  }
+
+  Source outerSource = source;
+  source.argIndex = 0;
+  Layer outerLayer = layer;
+  layer = ArgumentParser::argvLayer;
+
+  const char *lastKey = NULL;
+  char *end = &buffer[length];
+  char *cursor = &buffer[0];
+  char *token;
+  bool failed = false;
+  while (!failed && (token = nextToken(&cursor, end)) != NULL)
+  {
+    failed = parseArgument(token, lastKey, 0);
+    ++source.argIndex;
+  }
+
+  if (!failed && lastKey != NULL)
+  {
+    setPendingKey(lastKey, NULL);
+  }
+
+  if (batchParsing)
+  {
+    commitBatch();
+  }
+  endCallbacks();
+
+  buffer.swap(commandBuffer);
+  source = outerSource;
+  layer = outerLayer;
+
+  lookForHelp();
+}
+
+void ArgumentParserInternals::parseEnvironment(const char *prefix,
+  ArgumentParser::KeyCase keyCase)
+{
+  STATS_SCOPE(&stats);
+  STATS_TIMER(tokenizingTime);
+
+  size_t prefixLength = prefix ? strlen(prefix) : 0;
+
+  Layer outerLayer = layer;
+  layer = ArgumentParser::environmentLayer;
+
+  beginCallbacks();
+  if (batchParsing)
+  {
+    beginBatch();
+  }
+
+  char longKey[1024];
+  for (char **variable = environ; variable != NULL && *variable != NULL;
+    ++variable)
+  {
+    const char *name = *variable;
+    if (prefixLength > 0)
+    {
+      if (strncmp(name, prefix, prefixLength) != 0
+        || name[prefixLength] != '_')
+      {
+        continue;
+      }
+      name += prefixLength + 1;
+    }
+
+    const char *equals = strchr(name, '=');
+    if (equals == NULL || equals == name
+      || size_t(equals - name) >= sizeof(longKey))
+    {
+      continue;
+    }
+
+    // keys have no underscores, so '_' or '__' separates the parts of a
+    // dotted key
+    size_t length = 0;
+    for (const char *c = name; c < equals; ++c)
+    {
+      if (*c == '_')
+      {
+        while (c[1] == '_')
+        {
+          ++c;
+        }
+        longKey[length++] = '.';
       } else
       {
-        set(lastKey, argv[i]);
-        lastKey = NULL;
+        longKey[length++] = keyCase == ArgumentParser::lowerCase
+          ? tolower((unsigned char) *c) : *c;
       }
-    } else
+    }
+    longKey[length] = '\0';
+
+    unsigned int id = fetchId(longKey);
+    if (id != noId)
+    {
+      set(id, equals + 1);
+    }
+  }
+
+  if (batchParsing)
+  {
+    commitBatch();
+  }
+  endCallbacks();
+
+  layer = outerLayer;
+
+  lookForHelp();
+}
+
+void ArgumentParserInternals::setPendingKey(const char *key,
+  const char *value)
+{
+  // the value belongs to the argument of the key
+  Source current = source;
+  source = keySource;
+
+  if (value == NULL)
+  {
+    set(key, true);
+  } else
+  {
+    set(key, value);
+  }
+
+  source = current;
+}
+
+bool ArgumentParserInternals::parseArgument(char *arg, const char *&lastKey,
+  unsigned int depth)
+{
+  if (arg[0] == '@' && arg[1] != '\0')
+  {
+    switch (parseResponseFile(&arg[1], lastKey, depth + 1))
+    {
+    case responseFileParsed:
+      return false;
+    case responseFileFailed:
+      return true;
+    case responseFileMissing:
+      // like gcc, treat the argument literally
+      break;
+    }
+  }
+
+  if (arg[0] != '-')
+  {
+    // the first standalone may select a sub-command. A pending bool switch
+    // doesn't take it as its value
+    unsigned int index = findSubcommand(arg);
+    if (index != noId && (lastKey == NULL || isBoolKey(lastKey)))
     {
-      if (lastKey)
+      if (lastKey != NULL)
       {
-        // must be boolean (i.e. true)
-        set(lastKey, true);
+        setPendingKey(lastKey, NULL);
         lastKey = NULL;
       }
+      selectSubcommand(index);
+      return false;
+    }
 
-      if (argv[i][1] == '-')
-      {
-        // this is a long key
+    // this is a value
+    if (lastKey == NULL)
+    {
+#ifdef DEBUG
+      cout << "adding standalone argument"<< endl;
+#endif
+
+      addStandalone(arg);
+    } else
+    {
+      setPendingKey(lastKey, arg);
+      lastKey = NULL;
+    }
+  } else
+  {
+    if (lastKey)
+    {
+      // must be boolean (i.e. true)
+      setPendingKey(lastKey, NULL);
+      lastKey = NULL;
+    }
+
+    if (arg[1] == '-')
+    {
+      // this is a long key
 
-        char *arg = &(argv[i][2]);
-        char *eqpos = strchr(arg, '=');
-        if (eqpos != NULL)
+      char *key = &(arg[2]);
+      char *eqpos = strchr(key, '=');
+      if (eqpos != NULL)
+      {
+        if (eqpos == key)
         {
-          if (eqpos == arg)
-          {
-            cerr << "missing key in option '" << arg << "'" << endl;
-            return;
-          } else
-          {
-            *eqpos = '\0';
-            ++eqpos;
-            set(arg, eqpos);
-          }
+          cerr << "missing key in option '" << key << "'" << endl;
+          return true;
         } else
         {
-          lastKey = &(argv[i][2]);
+          *eqpos = '\0';
+          ++eqpos;
+          set(key, eqpos);
         }
       } else
       {
-        char *keys = &(argv[i][1]);
-        int size = strlen(keys) - 1;
+        lastKey = key;
+        keySource = source;
+      }
+    } else
+    {
+      // this is a short key (or sequence thereof)
+      char *keys = &(arg[1]);
+      int size = strlen(keys) - 1;
 
-        char *eqpos = strchr(keys, '=');
-        if (eqpos == NULL)
+      char *eqpos = strchr(keys, '=');
+      if (eqpos == NULL)
+      {
+        for (int j = 0; j < size; ++j)
         {
-          for (int j = 0; j < size; ++i)
+          // must be bool
+          const char *longKey = getLongKey(keys[j]);
+          if (longKey != NULL)
           {
-            // must be bool
-            set(getLongKey(keys[j]), true);
+            set(longKey, true);
           }
+        }
 
-          lastKey = getLongKey(keys[size]);
-        } else if (eqpos - keys != 1)
-        {
-          cerr << "syntax error in option '" << argv[i] << "'" << endl;
-          return;
-        } else
+        lastKey = getLongKey(keys[size]);
+        keySource = source;
+      } else if (eqpos - keys != 1)
+      {
+        cerr << "syntax error in option '" << arg << "'" << endl;
+        return true;
+      } else
+      {
+        ++eqpos;
+        const char *longKey = getLongKey(keys[0]);
+        if (longKey != NULL)
         {
-          ++eqpos;
-          set(getLongKey(keys[0]), eqpos);
+          set(longKey, eqpos);
         }
-
-        // this is a short key (or sequence thereof)
       }
     }
   }
 
-  if (lastKey != NULL)
+  return false;
+}
+
+ArgumentParserInternals::ResponseFileResult
+ArgumentParserInternals::parseResponseFile(const char *filename,
+  const char *&lastKey, unsigned int depth)
+{
+  if (depth > maxResponseFileDepth)
   {
-#ifdef DEBUG
-    cout << "setting last key to true" << endl;
-#endif
+    cerr << "response file '" << filename << "' nested too deeply" << endl;
+    return responseFileFailed;
+  }
 
-    set(lastKey, true);
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+  {
+    return responseFileMissing;
   }
 
-#ifdef DEBUG
-  cout << "done parsing"<< endl;
-#endif
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+  {
+    close(fd);
+    return responseFileMissing;
+  }
 
-  lookForHelp();
+  size_t size = fileStat.st_size;
+  if (size == 0)
+  {
+    close(fd);
+    return responseFileParsed;
+  }
+
+  // Reserve at least one zeroed byte after the end of the file, which the
+  // tokenizer needs to terminate the last word. The file is mapped privately
+  // on top of it, so tokenizing in place never touches the file itself.
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t length = (size / pageSize + 1) * pageSize;
+  char *buffer = (char*) mmap(NULL, length, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer == MAP_FAILED)
+  {
+    close(fd);
+    return responseFileMissing;
+  }
+
+  if (mmap(buffer, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd,
+    0) == MAP_FAILED)
+  {
+    munmap(buffer, length);
+    close(fd);
+    return responseFileMissing;
+  }
+  close(fd);
+
+  char *end = buffer + size;
+  *end = '\0';
+
+  ++includeDepth;
+  STATS_MAX(maxIncludeDepth, includeDepth);
+
+  const char *outerFile = source.file;
+  unsigned int outerLine = source.line;
+  source.file = storeFileName(filename);
+  source.line = 0;
+
+  ResponseFileResult result = responseFileParsed;
+  char *cursor = buffer;
+  char *token;
+  while ((token = nextToken(&cursor, end)) != NULL)
+  {
+    if (parseArgument(token, lastKey, depth))
+    {
+      result = responseFileFailed;
+      break;
+    }
+  }
+
+  // a pending long key must not point into the mapping
+  if (lastKey >= buffer && lastKey < buffer + length)
+  {
+    unsigned int id = fetchId(lastKey);
+    if (id == noId)
+    {
+      setPendingKey(lastKey, NULL);
+      lastKey = NULL;
+    } else
+    {
+      lastKey = schema->getOption(id).longKey;
+    }
+  }
+
+  munmap(buffer, length);
+  --includeDepth;
+  source.file = outerFile;
+  source.line = outerLine;
+
+  return result;
+}
+
+static bool isWritable(const Argument *argument)
+{
+  return argument != NULL && argument->wasSet()
+    && !argument->hasType(Argument::noType);
+}
+
+static void writeValue(ostream &file, const char *name,
+  const Argument *argument)
+{
+  if (!isWritable(argument))
+  {
+    return;
+  }
+
+  file << name << " = ";
+  file.precision(16);
+  switch (argument->getType())
+  {
+  case Argument::boolType:
+    file << (argument->getBool() ? "true" : "false");
+    break;
+  case Argument::intType:
+    file << argument->getInt();
+    break;
+  case Argument::uintType:
+    file << argument->getUInt();
+    break;
+  case Argument::doubleType:
+    file << argument->getDouble();
+    break;
+  case Argument::stringType:
+    file << argument->getString();
+    break;
+  case Argument::noType:
+    // already handled by isWritable()
+    break;
+  }
+  file << endl;
 }
 
 bool ArgumentParserInternals::writeFile(const char *filename)
@@ -1186,36 +2490,41 @@ bool ArgumentParserInternals::writeFile(const char *filename)
     return true;
   }
 
-  for (ArgumentMap::iterator it = arguments.begin(); it != arguments.end();
-    ++it)
+  const Schema::SectionKey *keys;
+  size_t count;
+  schema->getSection("", keys, count);
+
+  // keys without a section first, then each top-level section in one block
+  for (size_t i = 0; i < count; ++i)
   {
-    if (wasValueSet(it->first, true) && !it->second.hasType(Argument::noType))
+    if (strchr(keys[i].longKey, '.') == NULL)
     {
-      file << it->first << " = ";
-      file.precision(16);
-      switch (it->second.getType())
-      {
-      case Argument::boolType:
-        file << (it->second.getBool() ? "true" : "false");
-        break;
-      case Argument::intType:
-        file << it->second.getInt();
-        break;
-      case Argument::uintType:
-        file << it->second.getUInt();
-        break;
-      case Argument::doubleType:
-        file << it->second.getDouble();
-        break;
-      case Argument::stringType:
-        file << it->second.getString();
-        break;
-      case Argument::noType:
-        // already handled in condition block
-        break;
-      }
-      file << endl;
+      writeValue(file, keys[i].longKey, fetchArgument(keys[i].id, true));
+    }
+  }
+
+  const char *section = NULL;
+  size_t sectionLength = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const char *longKey = keys[i].longKey;
+    const char *dot = strchr(longKey, '.');
+    const Argument *argument = fetchArgument(keys[i].id, true);
+    if (dot == NULL || !isWritable(argument))
+    {
+      continue;
+    }
+
+    if (section == NULL || size_t(dot - longKey) != sectionLength
+      || strncmp(section, longKey, sectionLength) != 0)
+    {
+      section = longKey;
+      sectionLength = dot - longKey;
+      file << endl << '[';
+      file.write(section, sectionLength);
+      file << ']' << endl;
     }
+    writeValue(file, dot + 1, argument);
   }
 
   file.close();
@@ -1223,13 +2532,188 @@ bool ArgumentParserInternals::writeFile(const char *filename)
   return false;
 }
 
+bool ArgumentParserInternals::isCompletionQuery(int argc, char **argv)
+{
+  return argc > 1 && strcmp(argv[1], "--complete") == 0;
+}
+
+void ArgumentParserInternals::buildCompletionIndex(vector<char> &buffer)
+{
+  vector<const char*> names;
+  for (SubcommandVector::const_iterator it = subcommands.begin();
+    it != subcommands.end(); ++it)
+  {
+    names.push_back(it->name);
+  }
+
+  CompletionIndex::build(*schema, names, buffer);
+}
+
+bool ArgumentParserInternals::writeCompletionIndex(const char *filename)
+{
+  CompletionIndex::Buffer buffer;
+  buildCompletionIndex(buffer);
+
+  ofstream file(filename, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+  {
+    cerr << "can't open file '" << filename << "' for writing" << endl;
+    return true;
+  }
+
+  file.write(&buffer[0], buffer.size());
+  file.close();
+
+  return file.fail();
+}
+
+bool ArgumentParserInternals::complete(int argc, char **argv,
+  const char *indexFile)
+{
+  if (!isCompletionQuery(argc, argv))
+  {
+    return false;
+  }
+
+  int fd = open(indexFile, O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)
+    || fileStat.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  size_t size = fileStat.st_size;
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+
+  CompletionIndex index;
+  if (!index.open(static_cast<const char*>(data), size))
+  {
+    munmap(data, size);
+    return false;
+  }
+
+  index.complete(argv + 2, argc - 2, cout);
+  cout.flush();
+  exit(0);
+}
+
+// returns false if the help message has to be aborted
+bool ArgumentParserInternals::printOption(unsigned int id)
+{
+  const Schema::Option &option = schema->getOption(id);
+  const char *longKey = option.longKey;
+  const Schema::Comment &comment = option.comment;
+  const Argument *defaultValue =
+    option.defaultValue.wasSet() ? &option.defaultValue : NULL;
+  const Argument *argument = &option.defaultValue;
+  // print line with keys:
+  for (int i = 0; i < 256; ++i)
+  {
+    if (schema->fetchShortKey(i) == id)
+    {
+      printf("-%c, ", char(i));
+    }
+  }
+
+  printf("--%s", longKey);
+
+  switch (argument->getType())
+  {
+  case Argument::intType:
+    printf("  [int]");
+    break;
+  case Argument::uintType:
+    printf("  [uint]");
+    break;
+  case Argument::doubleType:
+    printf("  [double]");
+    break;
+  case Argument::stringType:
+    printf("  [string]");
+    break;
+  default:
+    break;
+  }
+
+  if (defaultValue != NULL)
+  {
+#ifndef RELEASE
+    assert(defaultValue->wasSet());
+#endif
+    printf("   (default = ");
+    switch (defaultValue->getType())
+    {
+    case Argument::noType:
+      cerr << "file options must not have default values" << endl;
+      return false;
+    case Argument::boolType:
+      if (defaultValue->getBool())
+      {
+        printf("true");
+      } else
+      {
+        printf("false");
+      }
+      break;
+    case Argument::intType:
+      printf("%d", defaultValue->getInt());
+      break;
+    case Argument::uintType:
+      printf("%u", defaultValue->getUInt());
+      break;
+    case Argument::doubleType:
+      printf("%lg", defaultValue->getDouble());
+      break;
+    case Argument::stringType:
+      printf("'%s'", defaultValue->getString());
+      break;
+    }
+
+    printf(")");
+  }
+  if (comment.text == NULL)
+  {
+    printf("\n");
+    return true;
+  }
+
+  printf(":\n\t%.*s\n", (int) comment.length, comment.text);
+
+  return true;
+}
+
 void ArgumentParserInternals::displayHelpMessage()
 {
-  printf("\nusage: %s [options]", progname);
+  if (subcommand != noId)
+  {
+    printf("\nusage: %s %s [options]", progname,
+      subcommands[subcommand].name);
+  } else if (!subcommands.empty())
+  {
+    printf("\nusage: %s [options] command [options]", progname);
+  } else
+  {
+    printf("\nusage: %s [options]", progname);
+  }
+  const char *standaloneHelpKey = schema->getStandaloneHelpKey();
+  const char *standaloneComment = schema->getStandaloneComment();
+  int maxStandalones = schema->getMaxStandalones();
   if (standaloneHelpKey == NULL)
   {
     cerr << "no standaloneHelpKey defined" << endl;
-    standaloneHelpKey = strdup("argument");
+    standaloneHelpKey = "argument";
   }
 
   switch (maxStandalones)
@@ -1252,88 +2736,86 @@ void ArgumentParserInternals::displayHelpMessage()
     printf("\n\n%s:\n\t%s", standaloneHelpKey, standaloneComment);
   }
 
-  printf("\n\nOptions:\n");
-
-  for (ArgumentMap::iterator it = arguments.begin(); it != arguments.end();
-    ++it)
+  if (subcommand == noId && !subcommands.empty())
   {
-    const char *longKey = it->first;
-    const char *comment = fetchComment(longKey);
-    Argument *defaultValue = fetchDefault(longKey);
-    Argument *argument = fetchArgument(longKey);
-    // print line with keys:
-    for (int i = 0; i < 256; ++i)
+    printf("\n\nCommands:");
+    for (SubcommandVector::const_iterator it = subcommands.begin();
+      it != subcommands.end(); ++it)
     {
-      if (shortKeys[i] != NULL && strcmp(shortKeys[i], longKey) == 0)
+      if (it->comment == NULL)
+      {
+        printf("\n%s", it->name);
+      } else
       {
-        printf("-%c, ", char(i));
+        printf("\n%s:\n\t%s", it->name, it->comment);
       }
     }
+  }
 
-    printf("--%s", longKey);
+  // options of the selected sub-command are listed separately
+  unsigned int globalIds = subcommand == noId ? schema->size()
+    : subcommandFirstId;
 
-    switch (argument->getType())
+  printf("\n\nOptions:\n");
+
+  const Schema::KeyMap &keys = schema->getKeys();
+  for (Schema::KeyMap::const_iterator it = keys.begin(); it != keys.end();
+    ++it)
+  {
+    if (it->second < globalIds && !printOption(it->second))
     {
-    case Argument::intType:
-      printf("  [int]");
-      break;
-    case Argument::uintType:
-      printf("  [uint]");
-      break;
-    case Argument::doubleType:
-      printf("  [double]");
-      break;
-    case Argument::stringType:
-      printf("  [string]");
-      break;
-    default:
-      break;
+      return;
     }
+  }
 
-    if (defaultValue != NULL)
+  if (subcommand != noId)
+  {
+    printf("\n%s options:\n", subcommands[subcommand].name);
+    for (Schema::KeyMap::const_iterator it = keys.begin(); it != keys.end();
+      ++it)
     {
-#ifndef RELEASE
-      assert(defaultValue->wasSet());
-#endif
-      printf("   (default = ");
-      switch (defaultValue->getType())
+      if (it->second >= globalIds && !printOption(it->second))
       {
-      case Argument::noType:
-        cerr << "file options must not have default values" << endl;
         return;
-      case Argument::boolType:
-        if (defaultValue->getBool())
-        {
-          printf("true");
-        } else
-        {
-          printf("false");
-        }
-        break;
-      case Argument::intType:
-        printf("%d", defaultValue->getInt());
-        break;
-      case Argument::uintType:
-        printf("%u", defaultValue->getUInt());
-        break;
-      case Argument::doubleType:
-        printf("%lg", defaultValue->getDouble());
-        break;
-      case Argument::stringType:
-        printf("'%s'", defaultValue->getString());
-        break;
       }
-
-      printf(")");
     }
-    if (comment == NULL)
-    {
-      printf("\n");
-      continue;
-    }
-
-    printf(":\n\t%s\n", comment);
   }
 
   printf("\n");
 }
+
+MemoryUsage ArgumentParserInternals::memoryUsage()
+{
+  MemoryUsage usage;
+  memset(&usage, 0, sizeof(usage));
+
+  schema->addMemoryUsage(usage);
+  values.addMemoryUsage(usage);
+
+  usage.values += sizeof(*this) + valueTable.capacity() * sizeof(ArgumentValue)
+    + dirtySources.capacity() * sizeof(Source) + setKeys.memoryUsage()
+    + presentKeys.memoryUsage() + dirtyKeys.memoryUsage()
+    + changedKeys.memoryUsage();
+  usage.buffers += commandBuffer.capacity();
+  usage.strings += strlen(progname) + 1 + fileNameStrings.capacity();
+
+  usage.total = usage.options + usage.keyIndex + usage.strings + usage.values
+    + usage.buffers;
+
+  return usage;
+}
+
+ParseStats ArgumentParserInternals::getStats()
+{
+  ParseStats result = stats;
+#ifdef ARGUMENTPARSER_STATS
+  result.enabled = true;
+#endif
+
+  return result;
+}
+
+void ArgumentParserInternals::resetStats()
+{
+  memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,49 @@
+/*
+ * ArgumentSection.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+
+ArgumentSection::ArgumentSection() :
+  keys(NULL), count(0), prefixLength(0)
+{
+}
+
+ArgumentSection::ArgumentSection(const Key *_keys, size_t _count,
+  size_t _prefixLength) :
+  keys(_keys), count(_count), prefixLength(_prefixLength)
+{
+}
+
+size_t ArgumentSection::size() const
+{
+  return count;
+}
+
+bool ArgumentSection::empty() const
+{
+  return count == 0;
+}
+
+const ArgumentSection::Key *ArgumentSection::begin() const
+{
+  return keys;
+}
+
+const ArgumentSection::Key *ArgumentSection::end() const
+{
+  return keys + count;
+}
+
+const ArgumentSection::Key &ArgumentSection::operator[](size_t index) const
+{
+  return keys[index];
+}
+
+const char *ArgumentSection::getName(const Key &key) const
+{
+  return key.longKey + prefixLength;
+}
@@ -0,0 +1,144 @@
+/*
+ * Bitset.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <Bitset.hpp>
+
+Bitset::Bitset() :
+  bits(0)
+{
+}
+
+void Bitset::resize(size_t size)
+{
+  words.resize((size + wordBits - 1) / wordBits, 0);
+  bits = size;
+}
+
+size_t Bitset::size() const
+{
+  return bits;
+}
+
+size_t Bitset::memoryUsage() const
+{
+  return words.capacity() * sizeof(Word);
+}
+
+void Bitset::set(size_t index)
+{
+  if (index >= bits)
+  {
+    resize(index + 1);
+  }
+
+  words[index / wordBits] |= Word(1) << (index % wordBits);
+}
+
+void Bitset::reset(size_t index)
+{
+  if (index < bits)
+  {
+    words[index / wordBits] &= ~(Word(1) << (index % wordBits));
+  }
+}
+
+bool Bitset::test(size_t index) const
+{
+  if (index >= bits)
+  {
+    return false;
+  }
+
+  return (words[index / wordBits] >> (index % wordBits)) & 1;
+}
+
+void Bitset::clear()
+{
+  for (std::vector<Word>::iterator it = words.begin(); it != words.end(); ++it)
+  {
+    *it = 0;
+  }
+}
+
+bool Bitset::any() const
+{
+  for (std::vector<Word>::const_iterator it = words.begin(); it != words.end();
+    ++it)
+  {
+    if (*it != 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+size_t Bitset::findNext(size_t start) const
+{
+  size_t word = start / wordBits;
+  if (word >= words.size())
+  {
+    return npos;
+  }
+
+  Word current = words[word] & (~Word(0) << (start % wordBits));
+  while (current == 0)
+  {
+    if (++word >= words.size())
+    {
+      return npos;
+    }
+    current = words[word];
+  }
+
+  return word * wordBits + __builtin_ctzl(current);
+}
+
+Bitset &Bitset::operator|=(const Bitset &other)
+{
+  if (other.bits > bits)
+  {
+    resize(other.bits);
+  }
+
+  for (size_t i = 0; i < other.words.size(); ++i)
+  {
+    words[i] |= other.words[i];
+  }
+
+  return *this;
+}
+
+bool Bitset::isSubsetOf(const Bitset &other) const
+{
+  for (size_t i = 0; i < words.size(); ++i)
+  {
+    Word otherWord = i < other.words.size() ? other.words[i] : 0;
+    if ((words[i] & ~otherWord) != 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Bitset::intersects(const Bitset &other) const
+{
+  size_t count = words.size() < other.words.size() ? words.size()
+    : other.words.size();
+  for (size_t i = 0; i < count; ++i)
+  {
+    if ((words[i] & other.words[i]) != 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,207 @@
+/*
+ * CallbackScheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <CallbackScheduler.hpp>
+
+using namespace std;
+
+CallbackScheduler::CallbackScheduler(unsigned int threads) :
+  pool(threads), unfinished(0)
+{
+  // the last slot belongs to the standalones
+  lastTasks.push_back(NULL);
+}
+
+CallbackScheduler::~CallbackScheduler()
+{
+  {
+    lock_guard<mutex> lock(taskMutex);
+    for (vector<Task*>::iterator it = pending.begin(); it != pending.end();
+      ++it)
+    {
+      delete *it;
+      --unfinished;
+    }
+    pending.clear();
+  }
+
+  wait();
+}
+
+unsigned int CallbackScheduler::getThreadCount() const
+{
+  return pool.size();
+}
+
+CallbackScheduler::Task *&CallbackScheduler::lastTask(unsigned int slot)
+{
+  if (slot == Schema::noId)
+  {
+    return lastTasks.back();
+  }
+
+  if (slot + 1 >= lastTasks.size())
+  {
+    Task *standalones = lastTasks.back();
+    lastTasks.back() = NULL;
+    lastTasks.resize(slot + 2, NULL);
+    lastTasks.back() = standalones;
+  }
+
+  return lastTasks[slot];
+}
+
+void CallbackScheduler::addPredecessor(Task *task, Task *predecessor)
+{
+  predecessor->successors.push_back(task);
+  ++task->waitingFor;
+}
+
+void CallbackScheduler::queue(const Schema &schema, unsigned int id,
+  const ArgumentParser::Event &event)
+{
+  Task *task = new Task;
+  task->scheduler = this;
+  task->slot = id;
+  if (id == Schema::noId)
+  {
+    task->callbacks = schema.getStandaloneCallbacks();
+  } else
+  {
+    task->callbacks = schema.getOption(id).getLinks().callbacks;
+  }
+  task->event = event;
+  task->waitingFor = 0;
+
+  lock_guard<mutex> lock(taskMutex);
+  pending.push_back(task);
+  ++unfinished;
+}
+
+void CallbackScheduler::release(const Schema &schema)
+{
+  vector<Task*> ready;
+
+  {
+    lock_guard<mutex> lock(taskMutex);
+
+    // tasks of the same slot run in order
+    for (vector<Task*>::iterator it = pending.begin(); it != pending.end();
+      ++it)
+    {
+      Task *&last = lastTask((*it)->slot);
+      if (last != NULL)
+      {
+        addPredecessor(*it, last);
+      }
+      last = *it;
+    }
+
+    // declared order: wait for the latest task of every key that comes first
+    for (vector<Task*>::iterator it = pending.begin(); it != pending.end();
+      ++it)
+    {
+      Task *task = *it;
+      if (task->slot == Schema::noId)
+      {
+        continue;
+      }
+
+      const vector<unsigned int> &after =
+        schema.getOption(task->slot).getLinks().callbacksAfter;
+      for (vector<unsigned int>::const_iterator id = after.begin();
+        id != after.end(); ++id)
+      {
+        Task *predecessor = lastTask(*id);
+        if (predecessor != NULL && predecessor != task)
+        {
+          addPredecessor(task, predecessor);
+        }
+      }
+    }
+
+    for (vector<Task*>::iterator it = pending.begin(); it != pending.end();
+      ++it)
+    {
+      if ((*it)->waitingFor == 0)
+      {
+        ready.push_back(*it);
+      }
+    }
+    pending.clear();
+  }
+
+  for (vector<Task*>::iterator it = ready.begin(); it != ready.end(); ++it)
+  {
+    pool.submit(&CallbackScheduler::run, *it);
+  }
+}
+
+void CallbackScheduler::run(void *argument)
+{
+  Task *task = static_cast<Task*>(argument);
+
+  for (Schema::CallbackVector::const_iterator it = task->callbacks.begin();
+    it != task->callbacks.end(); ++it)
+  {
+    task->event.data = it->data;
+    it->callback(task->event);
+  }
+
+  task->scheduler->finish(task);
+}
+
+void CallbackScheduler::finish(Task *task)
+{
+  vector<Task*> ready;
+
+  {
+    lock_guard<mutex> lock(taskMutex);
+
+    for (vector<Task*>::iterator it = task->successors.begin();
+      it != task->successors.end(); ++it)
+    {
+      if (--(*it)->waitingFor == 0)
+      {
+        ready.push_back(*it);
+      }
+    }
+
+    Task *&last = lastTask(task->slot);
+    if (last == task)
+    {
+      last = NULL;
+    }
+
+    if (--unfinished == 0)
+    {
+      finished.notify_all();
+    }
+  }
+
+  delete task;
+
+  for (vector<Task*>::iterator it = ready.begin(); it != ready.end(); ++it)
+  {
+    pool.submit(&CallbackScheduler::run, *it);
+  }
+}
+
+void CallbackScheduler::wait()
+{
+  unique_lock<mutex> lock(taskMutex);
+  while (unfinished > pending.size())
+  {
+    finished.wait(lock);
+  }
+}
+
+bool CallbackScheduler::done()
+{
+  lock_guard<mutex> lock(taskMutex);
+  return unfinished == pending.size();
+}
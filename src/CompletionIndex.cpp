@@ -0,0 +1,376 @@
+/*
+ * CompletionIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <CompletionIndex.hpp>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static const char magic[4] = { 'A', 'P', 'C', 'I' };
+
+static bool lessName(const char *a, const char *b)
+{
+  return strcmp(a, b) < 0;
+}
+
+static void append(CompletionIndex::Buffer &buffer, const void *data,
+  size_t size)
+{
+  const char *bytes = static_cast<const char*>(data);
+  buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+CompletionIndex::CompletionIndex() :
+  header(NULL), keys(NULL), shortKeys(NULL), commands(NULL), strings(NULL)
+{
+}
+
+void CompletionIndex::build(const Schema &schema,
+  const vector<const char*> &commandNames, Buffer &buffer)
+{
+  const Schema::KeyMap &keyMap = schema.getKeys();
+
+  vector<const char*> sortedCommands(commandNames);
+  sort(sortedCommands.begin(), sortedCommands.end(), lessName);
+
+  // the key map is sorted already
+  Buffer names;
+  vector<Key> keyVector;
+  vector<uint32_t> keyOfId(schema.size(), 0);
+  for (Schema::KeyMap::const_iterator it = keyMap.begin(); it != keyMap.end();
+    ++it)
+  {
+    Key key;
+    key.name = names.size();
+    key.type = schema.getOption(it->second).type;
+    keyOfId[it->second] = keyVector.size();
+    keyVector.push_back(key);
+    append(names, it->first, strlen(it->first) + 1);
+  }
+
+  vector<ShortKey> shortKeyVector;
+  for (unsigned int shortKey = 1; shortKey < 256; ++shortKey)
+  {
+    unsigned int id = schema.fetchShortKey(shortKey);
+    if (id != Schema::noId)
+    {
+      ShortKey entry;
+      entry.shortKey = shortKey;
+      entry.key = keyOfId[id];
+      shortKeyVector.push_back(entry);
+    }
+  }
+
+  vector<uint32_t> commandVector;
+  for (vector<const char*>::const_iterator it = sortedCommands.begin();
+    it != sortedCommands.end(); ++it)
+  {
+    commandVector.push_back(names.size());
+    append(names, *it, strlen(*it) + 1);
+  }
+
+  Header indexHeader;
+  memcpy(indexHeader.magic, magic, sizeof(magic));
+  indexHeader.version = version;
+  indexHeader.keyCount = keyVector.size();
+  indexHeader.shortKeyCount = shortKeyVector.size();
+  indexHeader.commandCount = commandVector.size();
+  indexHeader.stringBytes = names.size();
+
+  buffer.clear();
+  append(buffer, &indexHeader, sizeof(indexHeader));
+  if (!keyVector.empty())
+  {
+    append(buffer, &keyVector[0], keyVector.size() * sizeof(Key));
+  }
+  if (!shortKeyVector.empty())
+  {
+    append(buffer, &shortKeyVector[0],
+      shortKeyVector.size() * sizeof(ShortKey));
+  }
+  if (!commandVector.empty())
+  {
+    append(buffer, &commandVector[0],
+      commandVector.size() * sizeof(uint32_t));
+  }
+  if (!names.empty())
+  {
+    append(buffer, &names[0], names.size());
+  }
+}
+
+bool CompletionIndex::open(const char *data, size_t size)
+{
+  header = NULL;
+
+  if (size < sizeof(Header))
+  {
+    return false;
+  }
+
+  const Header *candidate = reinterpret_cast<const Header*>(data);
+  if (memcmp(candidate->magic, magic, sizeof(magic)) != 0
+    || candidate->version != version)
+  {
+    return false;
+  }
+
+  unsigned long long expected = sizeof(Header)
+    + (unsigned long long) candidate->keyCount * sizeof(Key)
+    + (unsigned long long) candidate->shortKeyCount * sizeof(ShortKey)
+    + (unsigned long long) candidate->commandCount * sizeof(uint32_t)
+    + candidate->stringBytes;
+  if (expected != size)
+  {
+    return false;
+  }
+
+  const char *cursor = data + sizeof(Header);
+  const Key *indexKeys = reinterpret_cast<const Key*>(cursor);
+  cursor += candidate->keyCount * sizeof(Key);
+  const ShortKey *indexShortKeys = reinterpret_cast<const ShortKey*>(cursor);
+  cursor += candidate->shortKeyCount * sizeof(ShortKey);
+  const uint32_t *indexCommands = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += candidate->commandCount * sizeof(uint32_t);
+
+  // every name has to end within the strings
+  uint32_t stringBytes = candidate->stringBytes;
+  if (stringBytes != 0 && cursor[stringBytes - 1] != '\0')
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < candidate->keyCount; ++i)
+  {
+    if (indexKeys[i].name >= stringBytes)
+    {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < candidate->shortKeyCount; ++i)
+  {
+    if (indexShortKeys[i].key >= candidate->keyCount)
+    {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < candidate->commandCount; ++i)
+  {
+    if (indexCommands[i] >= stringBytes)
+    {
+      return false;
+    }
+  }
+
+  header = candidate;
+  keys = indexKeys;
+  shortKeys = indexShortKeys;
+  commands = indexCommands;
+  strings = cursor;
+
+  return true;
+}
+
+const char *CompletionIndex::name(uint32_t offset) const
+{
+  return strings + offset;
+}
+
+const CompletionIndex::Key *CompletionIndex::lowerBound(const char *prefix,
+  size_t length) const
+{
+  const Key *first = keys;
+  size_t count = header->keyCount;
+  while (count > 0)
+  {
+    size_t half = count / 2;
+    if (strncmp(name(first[half].name), prefix, length) < 0)
+    {
+      first += half + 1;
+      count -= half + 1;
+    } else
+    {
+      count = half;
+    }
+  }
+
+  return first;
+}
+
+const CompletionIndex::Key *CompletionIndex::findKey(const char *keyName,
+  size_t length) const
+{
+  const Key *key = lowerBound(keyName, length);
+  if (key != keys + header->keyCount)
+  {
+    const char *candidate = name(key->name);
+    if (strncmp(candidate, keyName, length) == 0 && candidate[length] == '\0')
+    {
+      return key;
+    }
+  }
+
+  return NULL;
+}
+
+const CompletionIndex::Key *CompletionIndex::findShortKey(
+  unsigned char shortKey) const
+{
+  for (uint32_t i = 0; i < header->shortKeyCount; ++i)
+  {
+    if (shortKeys[i].shortKey == shortKey)
+    {
+      return &keys[shortKeys[i].key];
+    }
+  }
+
+  return NULL;
+}
+
+bool CompletionIndex::isCommand(const char *word) const
+{
+  for (uint32_t i = 0; i < header->commandCount; ++i)
+  {
+    if (strcmp(name(commands[i]), word) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void CompletionIndex::completeKeys(const char *word, ostream &output) const
+{
+  if (word[1] != '-')
+  {
+    for (uint32_t i = 0; i < header->shortKeyCount; ++i)
+    {
+      char shortKey = shortKeys[i].shortKey;
+      if (word[1] == '\0' || (word[1] == shortKey && word[2] == '\0'))
+      {
+        output << '-' << shortKey << '\n';
+      }
+    }
+  }
+
+  if (word[1] == '-' || word[1] == '\0')
+  {
+    const char *prefix = word[1] == '\0' ? word + 1 : word + 2;
+    size_t length = strlen(prefix);
+    const Key *end = keys + header->keyCount;
+    for (const Key *key = lowerBound(prefix, length); key != end; ++key)
+    {
+      const char *keyName = name(key->name);
+      if (strncmp(keyName, prefix, length) != 0)
+      {
+        break;
+      }
+      output << "--" << keyName << '\n';
+    }
+  }
+}
+
+void CompletionIndex::completeCommands(const char *word, ostream &output) const
+{
+  size_t length = strlen(word);
+  for (uint32_t i = 0; i < header->commandCount; ++i)
+  {
+    const char *command = name(commands[i]);
+    if (strncmp(command, word, length) == 0)
+    {
+      output << command << '\n';
+    }
+  }
+}
+
+void CompletionIndex::completeBool(const char *prefix, size_t prefixLength,
+  const char *word, ostream &output)
+{
+  static const char *values[] = { "true", "false" };
+
+  size_t length = strlen(word);
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    if (strncmp(values[i], word, length) == 0)
+    {
+      output.write(prefix, prefixLength);
+      output << values[i] << '\n';
+    }
+  }
+}
+
+void CompletionIndex::complete(const char * const *words, size_t count,
+  ostream &output) const
+{
+  if (header == NULL)
+  {
+    return;
+  }
+
+  const char *word = count > 0 ? words[count - 1] : "";
+  const char *previous = count > 1 ? words[count - 2] : NULL;
+
+  if (word[0] == '-')
+  {
+    // --key=value and -k=value
+    const char *equals = strchr(word, '=');
+    if (equals != NULL)
+    {
+      const Key *key = NULL;
+      if (word[1] == '-')
+      {
+        key = findKey(word + 2, equals - word - 2);
+      } else if (equals == word + 2)
+      {
+        key = findShortKey(word[1]);
+      }
+
+      if (key != NULL && key->type == Argument::boolType)
+      {
+        completeBool(word, equals + 1 - word, equals + 1, output);
+      }
+      return;
+    }
+
+    completeKeys(word, output);
+    return;
+  }
+
+  // the value of a pending key. The last one of several short keys takes it
+  if (previous != NULL && previous[0] == '-' && previous[1] != '\0'
+    && strchr(previous, '=') == NULL)
+  {
+    const Key *key;
+    if (previous[1] == '-')
+    {
+      key = findKey(previous + 2, strlen(previous + 2));
+    } else
+    {
+      key = findShortKey(previous[strlen(previous) - 1]);
+    }
+
+    if (key != NULL)
+    {
+      if (key->type != Argument::boolType)
+      {
+        // numbers, strings and files are left to the shell
+        return;
+      }
+      completeBool("", 0, word, output);
+    }
+  }
+
+  for (size_t i = 0; i + 1 < count; ++i)
+  {
+    if (isCommand(words[i]))
+    {
+      return;
+    }
+  }
+  completeCommands(word, output);
+}
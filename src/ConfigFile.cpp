@@ -0,0 +1,135 @@
+/*
+ * ConfigFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ConfigFile.hpp>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+ConfigFile::ConfigFile() :
+  lineCount(0), opened(false)
+{
+}
+
+bool ConfigFile::joinKey(const char *section, const char *key,
+  size_t keyLength, char *longKey)
+{
+  size_t sectionLength = section != NULL ? strlen(section) + 1 : 0;
+  if (sectionLength + keyLength >= maxKeyLength)
+  {
+    return false;
+  }
+
+  if (section != NULL)
+  {
+    memcpy(longKey, section, sectionLength - 1);
+    longKey[sectionLength - 1] = '.';
+  }
+  memcpy(longKey + sectionLength, key, keyLength);
+  longKey[sectionLength + keyLength] = '\0';
+
+  return true;
+}
+
+bool ConfigFile::load(const char *filename, const Schema &schema)
+{
+  buffer.clear();
+  entries.clear();
+  lineCount = 0;
+
+  ifstream file(filename, ios::in | ios::binary);
+  opened = file.is_open();
+  if (!opened)
+  {
+    return false;
+  }
+
+  // a single read, the lines are terminated in place
+  file.seekg(0, ios::end);
+  streamoff size = file.tellg();
+  file.seekg(0, ios::beg);
+  if (size < 0)
+  {
+    size = 0;
+  }
+  buffer.resize(size + 1);
+  file.read(&buffer[0], size);
+  buffer.resize(file.gcount() + 1);
+  buffer.back() = '\0';
+  file.close();
+
+  char *end = &buffer.back();
+  char *line = &buffer[0];
+  const char *section = NULL;
+  for (unsigned int number = 1; line < end; ++number)
+  {
+    char *lineEnd = static_cast<char*>(memchr(line, '\n', end - line));
+    if (lineEnd == NULL)
+    {
+      lineEnd = end;
+    }
+    *lineEnd = '\0';
+
+    if (line[0] != '\0')
+    {
+      ++lineCount;
+
+      Entry entry;
+      const char *keyEnd;
+      const char *valueEnd;
+      entry.type = splitLine(line, &entry.key, &keyEnd, &entry.value,
+        &valueEnd);
+      entry.line = number;
+      entry.text = line;
+      entry.section = section;
+      entry.id = Schema::noId;
+
+      if (entry.type == sectionLine)
+      {
+        line[keyEnd - line] = '\0';
+        section = entry.key;
+      } else if (entry.type == assignmentLine)
+      {
+        // the line is split, its text isn't needed anymore
+        line[keyEnd - line] = '\0';
+        line[valueEnd - line] = '\0';
+        entry.text = NULL;
+
+        char longKey[maxKeyLength];
+        if (joinKey(section, entry.key, keyEnd - entry.key, longKey))
+        {
+          entry.id = schema.fetchId(longKey);
+        }
+      }
+
+      if (entry.type != ignoredLine && entry.type != sectionLine)
+      {
+        entries.push_back(entry);
+      }
+    }
+
+    line = lineEnd + 1;
+  }
+
+  return true;
+}
+
+bool ConfigFile::isOpen() const
+{
+  return opened;
+}
+
+size_t ConfigFile::getLineCount() const
+{
+  return lineCount;
+}
+
+const ConfigFile::EntryVector &ConfigFile::getEntries() const
+{
+  return entries;
+}
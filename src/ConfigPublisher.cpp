@@ -0,0 +1,160 @@
+/*
+ * ConfigPublisher.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <ConfigPublisherData.hpp>
+#include <thread>
+
+using namespace std;
+
+ConfigPublisherData::ConfigPublisherData(const ConfigView *initial) :
+  current(initial), epoch(1)
+{
+  for (unsigned int i = 0; i < slotCount; ++i)
+  {
+    slots[i].used.store(false, memory_order_relaxed);
+    slots[i].epoch.store(quiescent, memory_order_relaxed);
+  }
+}
+
+ConfigPublisherData::~ConfigPublisherData()
+{
+  for (vector<Retired>::iterator it = retired.begin(); it != retired.end();
+    ++it)
+  {
+    delete it->view;
+  }
+
+  delete current.load(memory_order_relaxed);
+}
+
+unsigned int ConfigPublisherData::claimSlot()
+{
+  // start where this thread succeeded before, so slots stay uncontended
+  static thread_local unsigned int hint = 0;
+
+  while (true)
+  {
+    for (unsigned int i = 0; i < slotCount; ++i)
+    {
+      unsigned int slot = (hint + i) % slotCount;
+      if (!slots[slot].used.load(memory_order_relaxed)
+        && !slots[slot].used.exchange(true, memory_order_acquire))
+      {
+        hint = slot;
+        return slot;
+      }
+    }
+
+    // more concurrent readers than slots
+    this_thread::yield();
+  }
+}
+
+void ConfigPublisherData::releaseSlot(unsigned int slot)
+{
+  slots[slot].epoch.store(quiescent, memory_order_release);
+  slots[slot].used.store(false, memory_order_release);
+}
+
+void ConfigPublisherData::publish(const ConfigView *view)
+{
+  const ConfigView *previous = current.exchange(view);
+
+  Retired retiree;
+  retiree.view = previous;
+  retiree.epoch = epoch.fetch_add(1);
+
+  {
+    lock_guard<mutex> lock(retireMutex);
+    retired.push_back(retiree);
+  }
+
+  reclaim();
+}
+
+void ConfigPublisherData::reclaim()
+{
+  lock_guard<mutex> lock(retireMutex);
+
+  unsigned long oldest = epoch.load();
+  for (unsigned int i = 0; i < slotCount; ++i)
+  {
+    unsigned long slotEpoch = slots[i].epoch.load();
+    if (slotEpoch != quiescent && slotEpoch < oldest)
+    {
+      oldest = slotEpoch;
+    }
+  }
+
+  vector<Retired>::iterator keep = retired.begin();
+  for (vector<Retired>::iterator it = retired.begin(); it != retired.end();
+    ++it)
+  {
+    if (it->epoch < oldest)
+    {
+      delete it->view;
+    } else
+    {
+      *keep++ = *it;
+    }
+  }
+  retired.erase(keep, retired.end());
+}
+
+ConfigPublisher::Guard::Guard(const ConfigPublisher &publisher) :
+  data(publisher.data), slot(data->claimSlot())
+{
+  data->slots[slot].epoch.store(data->epoch.load());
+  view = data->current.load();
+}
+
+ConfigPublisher::Guard::~Guard()
+{
+  data->releaseSlot(slot);
+}
+
+const ConfigView &ConfigPublisher::Guard::operator*() const
+{
+  return *view;
+}
+
+const ConfigView *ConfigPublisher::Guard::operator->() const
+{
+  return view;
+}
+
+ConfigPublisher::ConfigPublisher(const ConfigView &initial) :
+  data(new ConfigPublisherData(new ConfigView(initial)))
+{
+}
+
+ConfigPublisher::~ConfigPublisher()
+{
+  delete data;
+}
+
+void ConfigPublisher::publish(const ConfigView &view)
+{
+  data->publish(new ConfigView(view));
+}
+
+void ConfigPublisher::publish(ArgumentParser &parser)
+{
+  data->publish(new ConfigView(parser.snapshot()));
+}
+
+ConfigView ConfigPublisher::get() const
+{
+  Guard guard(*this);
+  return *guard;
+}
+
+void ConfigPublisher::reclaim()
+{
+  data->reclaim();
+}
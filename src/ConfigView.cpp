@@ -0,0 +1,196 @@
+/*
+ * ConfigView.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ArgumentParser.h>
+#include <ConfigViewData.hpp>
+#include <Stats.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace std;
+
+ConfigViewData *ConfigViewData::create(size_t count, size_t standaloneCount,
+  size_t stringBytes)
+{
+  size_t size = sizeof(ConfigViewData) + count * sizeof(Entry)
+    + standaloneCount * sizeof(const char *) + stringBytes;
+
+  void *block;
+  if (posix_memalign(&block, cacheLine, size) != 0)
+  {
+    return NULL;
+  }
+  STATS_ALLOCATION(size);
+
+  ConfigViewData *data = new (block) ConfigViewData;
+  data->references.store(1, memory_order_relaxed);
+  data->count = count;
+  data->standaloneCount = standaloneCount;
+  data->entries = data->entryStorage();
+  data->standalones = data->standaloneStorage();
+
+  return data;
+}
+
+ConfigViewData::Entry *ConfigViewData::entryStorage()
+{
+  return reinterpret_cast<Entry*>(this + 1);
+}
+
+const char **ConfigViewData::standaloneStorage()
+{
+  return reinterpret_cast<const char **>(entryStorage() + count);
+}
+
+char *ConfigViewData::stringStorage()
+{
+  return reinterpret_cast<char*>(standaloneStorage() + standaloneCount);
+}
+
+const ConfigViewData::Entry *ConfigViewData::find(const char *longKey) const
+{
+  if (longKey == NULL)
+  {
+    return NULL;
+  }
+
+  size_t begin = 0;
+  size_t end = count;
+  while (begin < end)
+  {
+    size_t middle = begin + (end - begin) / 2;
+    int cmp = strcmp(entries[middle].key, longKey);
+    if (cmp == 0)
+    {
+      return &entries[middle];
+    } else if (cmp < 0)
+    {
+      begin = middle + 1;
+    } else
+    {
+      end = middle;
+    }
+  }
+
+  return NULL;
+}
+
+void ConfigViewData::acquire()
+{
+  references.fetch_add(1, memory_order_relaxed);
+}
+
+void ConfigViewData::release()
+{
+  if (references.fetch_sub(1, memory_order_acq_rel) == 1)
+  {
+    this->~ConfigViewData();
+    free(this);
+  }
+}
+
+ConfigView::ConfigView(ConfigViewData *_data) :
+  data(_data)
+{
+}
+
+ConfigView::ConfigView(const ConfigView &other) noexcept :
+  data(other.data)
+{
+  data->acquire();
+}
+
+ConfigView::~ConfigView()
+{
+  data->release();
+}
+
+ConfigView &ConfigView::operator=(const ConfigView &other) noexcept
+{
+  ConfigViewData *previous = data;
+  data = other.data;
+  data->acquire();
+  previous->release();
+
+  return *this;
+}
+
+bool ConfigView::keyExists(const char *longKey) const noexcept
+{
+  return data->find(longKey) != NULL;
+}
+
+bool ConfigView::wasValueSet(const char *longKey) const noexcept
+{
+  const ConfigViewData::Entry *entry = data->find(longKey);
+  return entry != NULL && entry->defined;
+}
+
+bool ConfigView::getBool(const char *longKey) const noexcept
+{
+  const ConfigViewData::Entry *entry = data->find(longKey);
+  if (entry == NULL || !entry->defined || entry->type != Argument::boolType)
+  {
+    return false;
+  }
+  return entry->boolValue;
+}
+
+int ConfigView::getInt(const char *longKey) const noexcept
+{
+  const ConfigViewData::Entry *entry = data->find(longKey);
+  if (entry == NULL || !entry->defined || entry->type != Argument::intType)
+  {
+    return 0;
+  }
+  return entry->intValue;
+}
+
+unsigned int ConfigView::getUInt(const char *longKey) const noexcept
+{
+  const ConfigViewData::Entry *entry = data->find(longKey);
+  if (entry == NULL || !entry->defined || entry->type != Argument::uintType)
+  {
+    return 0;
+  }
+  return entry->uintValue;
+}
+
+double ConfigView::getDouble(const char *longKey) const noexcept
+{
+  const ConfigViewData::Entry *entry = data->find(longKey);
+  if (entry == NULL || !entry->defined || entry->type != Argument::doubleType)
+  {
+    return 0.0;
+  }
+  return entry->doubleValue;
+}
+
+const char *ConfigView::getCString(const char *longKey) const noexcept
+{
+  const ConfigViewData::Entry *entry = data->find(longKey);
+  if (entry == NULL || !entry->defined || entry->type != Argument::stringType)
+  {
+    return NULL;
+  }
+  return entry->stringValue;
+}
+
+size_t ConfigView::getStandaloneCount() const noexcept
+{
+  return data->standaloneCount;
+}
+
+const char *ConfigView::getCStandalone(size_t index) const noexcept
+{
+  if (index >= data->standaloneCount)
+  {
+    return NULL;
+  }
+  return data->standalones[index];
+}
@@ -0,0 +1,548 @@
+/*
+ * Schema.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <Schema.hpp>
+#include <debug.hpp>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+Schema::CallbackContainer::CallbackContainer(const EventCallback &_callback,
+  void *_data) :
+  callback(_callback), data(_data)
+{
+}
+
+Schema::Target::Target(void *_pointer, Argument::ValueType _atomicType,
+  memory_order _order, size_t _size) :
+  pointer(_pointer), atomicType(_atomicType), order(_order), size(_size)
+{
+}
+
+Schema::Comment::Comment() :
+  length(0), text(NULL), owned(false)
+{
+}
+
+Schema::Option::Option(const char *_longKey, Argument::ValueType _type) :
+  longKey(_longKey), defaultValue(_type), links(NULL), type(_type)
+{
+}
+
+const Schema::Links &Schema::Option::getLinks() const
+{
+  static const Links none;
+  return links != NULL ? *links : none;
+}
+
+Schema::Schema() :
+  references(1), maxStandalones(0), standaloneLimit(0),
+    standaloneComment(NULL), standaloneHelpKey(strdup("argument")),
+    sectionsBuilt(false)
+{
+  for (int i = 0; i < 256; ++i)
+  {
+    shortKeys[i] = noId;
+  }
+}
+
+Schema::Schema(const Schema &other) :
+  references(1), keys(), options(other.options),
+    requiredKeys(other.requiredKeys), defaultKeys(other.defaultKeys),
+    constrainedKeys(other.constrainedKeys),
+    standaloneCallbacks(other.standaloneCallbacks),
+    maxStandalones(other.maxStandalones),
+    standaloneLimit(other.standaloneLimit), standaloneComment(NULL),
+    standaloneHelpKey(NULL), sectionsBuilt(false)
+{
+  for (unsigned int id = 0; id < options.size(); ++id)
+  {
+    Option &option = options[id];
+    option.longKey = strdup(option.longKey);
+    if (option.comment.owned)
+    {
+      option.comment.text = strdup(option.comment.text);
+    }
+    if (option.links != NULL)
+    {
+      option.links = new Links(*option.links);
+    }
+    keys.insert(KeyMap::value_type(option.longKey, id));
+  }
+
+  for (int i = 0; i < 256; ++i)
+  {
+    shortKeys[i] = other.shortKeys[i];
+  }
+
+  if (other.standaloneComment)
+  {
+    standaloneComment = strdup(other.standaloneComment);
+  }
+  if (other.standaloneHelpKey)
+  {
+    standaloneHelpKey = strdup(other.standaloneHelpKey);
+  }
+}
+
+Schema::~Schema()
+{
+  for (OptionVector::iterator it = options.begin(); it != options.end(); ++it)
+  {
+    free(const_cast<char*>(it->longKey));
+    if (it->comment.owned)
+    {
+      free(const_cast<char*>(it->comment.text));
+    }
+    delete it->links;
+  }
+
+  clearStandaloneStrings();
+}
+
+void Schema::clearStandaloneStrings()
+{
+  if (standaloneHelpKey)
+  {
+    free(standaloneHelpKey);
+    standaloneHelpKey = NULL;
+  }
+  if (standaloneComment)
+  {
+    free(standaloneComment);
+    standaloneComment = NULL;
+  }
+}
+
+Schema::Links &Schema::links(unsigned int id)
+{
+  Option &option = options[id];
+  if (option.links == NULL)
+  {
+    option.links = new Links;
+    STATS_ALLOCATION(sizeof(Links));
+  }
+
+  return *option.links;
+}
+
+Schema *Schema::acquire()
+{
+  references.fetch_add(1, memory_order_relaxed);
+  return this;
+}
+
+void Schema::release()
+{
+  if (references.fetch_sub(1, memory_order_acq_rel) == 1)
+  {
+    delete this;
+  }
+}
+
+bool Schema::isShared() const
+{
+  return references.load(memory_order_acquire) > 1;
+}
+
+Schema *Schema::clone() const
+{
+  return new Schema(*this);
+}
+
+unsigned int Schema::registerArgument(const char *longKey,
+  Argument::ValueType valueType)
+{
+  KeyMap::iterator it = keys.find(longKey);
+  if (it != keys.end())
+  {
+    return it->second;
+  }
+
+  unsigned int id = options.size();
+  const char *key = strdup(longKey);
+  STATS_ALLOCATION(strlen(longKey) + 1);
+  options.push_back(Option(key, valueType));
+  keys.insert(KeyMap::value_type(key, id));
+  sectionsBuilt.store(false, memory_order_relaxed);
+  if (valueType != Argument::noType)
+  {
+    requiredKeys.set(id);
+  }
+
+  return id;
+}
+
+Argument *Schema::registerDefault(unsigned int id)
+{
+  return &options[id].defaultValue;
+}
+
+void Schema::updateDefault(unsigned int id)
+{
+  if (options[id].defaultValue.wasSet())
+  {
+    defaultKeys.set(id);
+    requiredKeys.reset(id);
+  } else
+  {
+    defaultKeys.reset(id);
+    if (options[id].type != Argument::noType)
+    {
+      requiredKeys.set(id);
+    }
+  }
+}
+
+void Schema::registerRequirement(unsigned int id, unsigned int requiredId)
+{
+  links(id).requirements.set(requiredId);
+  constrainedKeys.set(id);
+}
+
+void Schema::registerConflict(unsigned int id, unsigned int conflictingId)
+{
+  links(id).conflicts.set(conflictingId);
+  constrainedKeys.set(id);
+}
+
+void Schema::registerShortKey(unsigned char shortKey, unsigned int id)
+{
+  if (isgraph(shortKey))
+  {
+    if (shortKeys[shortKey] == noId)
+    {
+      shortKeys[shortKey] = id;
+    } else if (shortKeys[shortKey] != id)
+    {
+      cerr << "shortkey -" << shortKey << " is already registered as --"
+        << options[shortKeys[shortKey]].longKey << endl;
+    }
+  }
+}
+
+void Schema::registerComment(unsigned int id, const char *comment,
+  bool borrow)
+{
+  if (comment == NULL)
+  {
+    return;
+  }
+
+  Comment &current = options[id].comment;
+  size_t length = strlen(comment);
+  if (current.text != NULL && current.length == length
+    && memcmp(current.text, comment, length) == 0)
+  {
+    // re-registration of the same comment
+    return;
+  }
+
+  if (current.owned)
+  {
+    free(const_cast<char*>(current.text));
+  }
+
+  current.length = length;
+  current.owned = !borrow;
+  if (borrow)
+  {
+    current.text = comment;
+  } else
+  {
+    current.text = strdup(comment);
+    STATS_ALLOCATION(length + 1);
+  }
+}
+
+void Schema::registerTarget(unsigned int id, void *target,
+  Argument::ValueType atomicType, memory_order order, size_t size)
+{
+  if (target != NULL)
+  {
+    links(id).targets.push_back(Target(target, atomicType, order, size));
+  }
+}
+
+void Schema::registerCallback(unsigned int id, const EventCallback &callback,
+  void *data)
+{
+  links(id).callbacks.push_back(CallbackContainer(callback, data));
+}
+
+void Schema::registerStandaloneCallback(const EventCallback &callback,
+  void *data)
+{
+  standaloneCallbacks.push_back(CallbackContainer(callback, data));
+}
+
+// whether after already has to wait for before, directly or transitively
+bool Schema::callbacksOrdered(unsigned int before, unsigned int after) const
+{
+  vector<bool> visited(options.size(), false);
+  vector<unsigned int> stack(1, after);
+  visited[after] = true;
+
+  while (!stack.empty())
+  {
+    const vector<unsigned int> &predecessors =
+      options[stack.back()].getLinks().callbacksAfter;
+    stack.pop_back();
+
+    for (vector<unsigned int>::const_iterator it = predecessors.begin();
+      it != predecessors.end(); ++it)
+    {
+      if (*it == before)
+      {
+        return true;
+      }
+      if (!visited[*it])
+      {
+        visited[*it] = true;
+        stack.push_back(*it);
+      }
+    }
+  }
+
+  return false;
+}
+
+bool Schema::registerCallbackOrder(unsigned int before, unsigned int after)
+{
+  if (before == after || callbacksOrdered(after, before))
+  {
+    return false;
+  }
+
+  if (!callbacksOrdered(before, after))
+  {
+    links(after).callbacksAfter.push_back(before);
+  }
+
+  return true;
+}
+
+void Schema::registerStandalones(int maximum, const char *helpKey,
+  const char *comment)
+{
+  if (maximum < 0)
+  {
+    maxStandalones = -1;
+    standaloneLimit = (size_t) -1;
+  } else
+  {
+    maxStandalones = maximum;
+    standaloneLimit = maximum;
+  }
+
+  clearStandaloneStrings();
+  if (helpKey != NULL)
+  {
+    // THIS is not ideal
+    standaloneHelpKey = strdup(helpKey);
+  }
+  if (comment)
+  {
+    standaloneComment = strdup(comment);
+  }
+}
+
+unsigned int Schema::size() const
+{
+  return options.size();
+}
+
+unsigned int Schema::fetchId(const char *longKey) const
+{
+  if (longKey == NULL)
+  {
+    return noId;
+  }
+
+  KeyMap::const_iterator it = keys.find(longKey);
+
+  if (it == keys.end())
+  {
+    return noId;
+  }
+
+  return it->second;
+}
+
+unsigned int Schema::fetchShortKey(unsigned char shortKey) const
+{
+  return shortKeys[shortKey];
+}
+
+const Schema::Option &Schema::getOption(unsigned int id) const
+{
+  return options[id];
+}
+
+const Schema::KeyMap &Schema::getKeys() const
+{
+  return keys;
+}
+
+void Schema::buildSections() const
+{
+  sortedKeys.clear();
+  sections.clear();
+  sectionNames.clear();
+
+  // section names never move, they're the keys of the section map
+  size_t bytes = 0;
+  for (KeyMap::const_iterator it = keys.begin(); it != keys.end(); ++it)
+  {
+    for (const char *dot = strchr(it->first, '.'); dot != NULL;
+      dot = strchr(dot + 1, '.'))
+    {
+      bytes += dot - it->first + 1;
+    }
+  }
+  sectionNames.reserve(bytes);
+
+  // sections of the previous key, by depth. The keys of a section are
+  // contiguous, so a section ends with the first key outside of it
+  vector<SectionMap::iterator> open;
+  sortedKeys.reserve(keys.size());
+  for (KeyMap::const_iterator it = keys.begin(); it != keys.end(); ++it)
+  {
+    SectionKey key = { it->first, (int) it->second };
+    unsigned int index = sortedKeys.size();
+    sortedKeys.push_back(key);
+
+    size_t depth = 0;
+    for (const char *dot = strchr(it->first, '.'); dot != NULL;
+      dot = strchr(dot + 1, '.'), ++depth)
+    {
+      size_t length = dot - it->first;
+      if (depth < open.size() && open[depth]->first[length] == '\0'
+        && strncmp(open[depth]->first, it->first, length) == 0)
+      {
+        ++open[depth]->second.count;
+        continue;
+      }
+
+      const char *name = sectionNames.data() + sectionNames.size();
+      sectionNames.insert(sectionNames.end(), it->first, dot);
+      sectionNames.push_back('\0');
+
+      SectionRange range = { index, 1 };
+      open.resize(depth);
+      open.push_back(
+        sections.insert(SectionMap::value_type(name, range)).first);
+    }
+    open.resize(depth);
+  }
+}
+
+bool Schema::getSection(const char *section, const SectionKey *&first,
+  size_t &count) const
+{
+  if (!sectionsBuilt.load(memory_order_acquire))
+  {
+    lock_guard<mutex> lock(sectionsMutex);
+    if (!sectionsBuilt.load(memory_order_relaxed))
+    {
+      buildSections();
+      sectionsBuilt.store(true, memory_order_release);
+    }
+  }
+
+  first = sortedKeys.empty() ? NULL : &sortedKeys[0];
+  count = sortedKeys.size();
+  if (section[0] == '\0')
+  {
+    return true;
+  }
+
+  SectionMap::const_iterator it = sections.find(section);
+  if (it == sections.end())
+  {
+    count = 0;
+    return false;
+  }
+
+  first += it->second.first;
+  count = it->second.count;
+  return true;
+}
+
+const Bitset &Schema::getRequiredKeys() const
+{
+  return requiredKeys;
+}
+
+const Bitset &Schema::getDefaultKeys() const
+{
+  return defaultKeys;
+}
+
+const Bitset &Schema::getConstrainedKeys() const
+{
+  return constrainedKeys;
+}
+
+void Schema::addMemoryUsage(MemoryUsage &usage) const
+{
+  usage.options += sizeof(*this) + options.capacity() * sizeof(Option);
+  // a red-black tree node: color, three pointers and the value
+  usage.keyIndex += keys.size()
+    * (4 * sizeof(void*) + sizeof(KeyMap::value_type))
+    + sortedKeys.capacity() * sizeof(SectionKey) + sectionNames.capacity()
+    + sections.size() * (4 * sizeof(void*) + sizeof(SectionMap::value_type));
+  usage.values += requiredKeys.memoryUsage() + defaultKeys.memoryUsage()
+    + constrainedKeys.memoryUsage();
+
+  for (OptionVector::const_iterator it = options.begin(); it != options.end();
+    ++it)
+  {
+    usage.strings += strlen(it->longKey) + 1 + it->defaultValue.memoryUsage();
+    if (it->comment.owned)
+    {
+      usage.strings += it->comment.length + 1;
+    }
+
+    if (it->links != NULL)
+    {
+      const Links &links = *it->links;
+      usage.options += sizeof(Links)
+        + links.targets.capacity() * sizeof(Target)
+        + links.callbacks.capacity() * sizeof(CallbackContainer)
+        + links.callbacksAfter.capacity() * sizeof(unsigned int)
+        + links.requirements.memoryUsage() + links.conflicts.memoryUsage();
+    }
+  }
+}
+
+const Schema::CallbackVector &Schema::getStandaloneCallbacks() const
+{
+  return standaloneCallbacks;
+}
+
+int Schema::getMaxStandalones() const
+{
+  return maxStandalones;
+}
+
+size_t Schema::getStandaloneLimit() const
+{
+  return standaloneLimit;
+}
+
+const char *Schema::getStandaloneComment() const
+{
+  return standaloneComment;
+}
+
+const char *Schema::getStandaloneHelpKey() const
+{
+  return standaloneHelpKey;
+}
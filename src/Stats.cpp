@@ -0,0 +1,15 @@
+/*
+ * Stats.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <Stats.hpp>
+
+#ifdef ARGUMENTPARSER_STATS
+
+thread_local ParseStats *activeStats = NULL;
+thread_local unsigned long long StatsTimer::nestedTime = 0;
+
+#endif
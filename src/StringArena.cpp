@@ -0,0 +1,151 @@
+/*
+ * StringArena.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <StringArena.hpp>
+#include <Stats.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+static std::atomic<unsigned int> nextTag(1);
+
+StringArena::StringArena() :
+  current(0), used(0), tag(nextTag.fetch_add(1, std::memory_order_relaxed))
+{
+  memset(freeRooms, 0, sizeof(freeRooms));
+}
+
+StringArena::~StringArena()
+{
+  for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end();
+    ++it)
+  {
+    free(it->data);
+  }
+}
+
+StringArena::Header *StringArena::header(const char *str)
+{
+  return reinterpret_cast<Header*>(const_cast<char*>(str) - sizeof(Header));
+}
+
+unsigned int StringArena::sizeClass(size_t size)
+{
+  unsigned int result = 0;
+  while ((minRoomSize << result) < size)
+  {
+    ++result;
+  }
+
+  return result;
+}
+
+char *StringArena::allocate(unsigned int roomClass)
+{
+  if (freeRooms[roomClass] != NULL)
+  {
+    char *room = freeRooms[roomClass];
+    memcpy(&freeRooms[roomClass], room, sizeof(char*));
+    return room;
+  }
+
+  size_t needed = sizeof(Header) + (minRoomSize << roomClass);
+
+  // find a block with enough room, starting at the current one
+  while (current < blocks.size() && blocks[current].size - used < needed)
+  {
+    ++current;
+    used = 0;
+  }
+
+  if (current == blocks.size())
+  {
+    Block block;
+    block.size = needed > blockSize ? needed : blockSize;
+    block.data = (char*) malloc(block.size);
+    STATS_ALLOCATION(block.size);
+    blocks.push_back(block);
+  }
+
+  char *room = blocks[current].data + used + sizeof(Header);
+  used += needed;
+
+  Header *roomHeader = header(room);
+  roomHeader->arena = tag;
+  roomHeader->sizeClass = roomClass;
+
+  return room;
+}
+
+const char *StringArena::store(const char *str)
+{
+  return store(str, strlen(str));
+}
+
+const char *StringArena::store(const char *str, size_t length)
+{
+  char *copy = allocate(sizeClass(length + 1));
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+
+  return copy;
+}
+
+const char *StringArena::replace(const char *old, const char *str)
+{
+  size_t length = strlen(str);
+  if (owns(old) && (minRoomSize << header(old)->sizeClass) > length)
+  {
+    // str may be a part of old
+    char *room = const_cast<char*>(old);
+    memmove(room, str, length + 1);
+    return room;
+  }
+
+  // copy first, str may be old
+  const char *copy = store(str, length);
+  release(old);
+
+  return copy;
+}
+
+void StringArena::release(const char *str)
+{
+  if (!owns(str))
+  {
+    return;
+  }
+
+  char *room = const_cast<char*>(str);
+  unsigned int roomClass = header(str)->sizeClass;
+  memcpy(room, &freeRooms[roomClass], sizeof(char*));
+  freeRooms[roomClass] = room;
+}
+
+bool StringArena::owns(const char *str) const
+{
+  return str != NULL && header(str)->arena == tag;
+}
+
+void StringArena::reset()
+{
+  current = 0;
+  used = 0;
+  memset(freeRooms, 0, sizeof(freeRooms));
+}
+
+size_t StringArena::capacity() const
+{
+  size_t bytes = 0;
+  for (std::vector<Block>::const_iterator it = blocks.begin();
+    it != blocks.end(); ++it)
+  {
+    bytes += it->size;
+  }
+
+  return bytes;
+}
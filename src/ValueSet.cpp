@@ -0,0 +1,496 @@
+/*
+ * ValueSet.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <ValueSet.hpp>
+#include <cstring>
+
+ValueSet::Level::Level(Level *_parent) :
+  references(1), parent(_parent)
+{
+}
+
+ValueSet::Level::~Level()
+{
+  if (parent != NULL)
+  {
+    parent->release();
+  }
+}
+
+ValueSet::Level *ValueSet::Level::acquire()
+{
+  references.fetch_add(1, std::memory_order_relaxed);
+  return this;
+}
+
+void ValueSet::Level::release()
+{
+  if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    delete this;
+  }
+}
+
+unsigned int ValueSet::Level::findEntry(unsigned int id) const
+{
+  if (slots.empty())
+  {
+    return noEntry;
+  }
+
+  unsigned int mask = slots.size() - 1;
+  for (unsigned int slot = (id * 2654435761u) & mask;;
+    slot = (slot + 1) & mask)
+  {
+    unsigned int entry = slots[slot];
+    if (entry == 0)
+    {
+      return noEntry;
+    }
+    if (entryIds[entry - 1] == id)
+    {
+      return entry - 1;
+    }
+  }
+}
+
+void ValueSet::Level::addSlot(unsigned int entry)
+{
+  unsigned int mask = slots.size() - 1;
+  unsigned int slot = (entryIds[entry] * 2654435761u) & mask;
+  while (slots[slot] != 0)
+  {
+    slot = (slot + 1) & mask;
+  }
+  slots[slot] = entry + 1;
+}
+
+void ValueSet::Level::clearEntries()
+{
+  entryIds.clear();
+  entryMasks.clear();
+  entryCells.clear();
+  slots.assign(slots.size(), 0);
+}
+
+ValueSet::ValueSet() :
+  level(new Level(NULL)), size(0)
+{
+}
+
+ValueSet::~ValueSet()
+{
+  level->release();
+}
+
+void ValueSet::update(const Schema &schema)
+{
+  if (size >= schema.size())
+  {
+    return;
+  }
+
+  if (level->parent != NULL)
+  {
+    // shared values don't know the new ids, the overlay gets them
+    for (unsigned int id = size; id < schema.size(); ++id)
+    {
+      addEntry(id, 0);
+      Argument::ValueType type = schema.getOption(id).type;
+      for (unsigned int i = 0; i < layerCount; ++i)
+      {
+        level->entryCells.push_back(Argument(type));
+      }
+    }
+    size = schema.size();
+    return;
+  }
+
+  level->layerMasks.resize(schema.size(), 0);
+  for (unsigned int i = 0; i < layerCount; ++i)
+  {
+    // only allocated layers grow
+    if (level->layers[i].empty() && i != layerCount - 1)
+    {
+      continue;
+    }
+
+    for (unsigned int id = size; id < schema.size(); ++id)
+    {
+      level->layers[i].push_back(Argument(schema.getOption(id).type));
+    }
+  }
+  size = schema.size();
+}
+
+void ValueSet::reset()
+{
+  if (level->parent != NULL)
+  {
+    // nothing of the shared values is left, so all ids are stored here again
+    ArgumentVector runtime;
+    runtime.reserve(size);
+    for (unsigned int id = 0; id < size; ++id)
+    {
+      runtime.push_back(Argument((*this)[id].getType()));
+    }
+
+    level->parent->release();
+    level->parent = NULL;
+    level->clearEntries();
+    runtimeValues().swap(runtime);
+    level->layerMasks.assign(size, 0);
+  } else
+  {
+    for (unsigned int i = 0; i < layerCount; ++i)
+    {
+      for (ArgumentVector::iterator it = level->layers[i].begin();
+        it != level->layers[i].end(); ++it)
+      {
+        it->clear();
+      }
+    }
+    level->layerMasks.assign(level->layerMasks.size(), 0);
+  }
+
+  level->strings.reset();
+  standaloneData.clear();
+  standaloneOffsets.clear();
+}
+
+void ValueSet::share(ValueSet &other)
+{
+  Level *frozen;
+  if (other.level->parent != NULL && other.level->entryIds.empty())
+  {
+    // other hasn't changed anything since it shared its values the last time
+    frozen = other.level->parent;
+  } else
+  {
+    // other continues in an overlay, which takes over its reference
+    frozen = other.level;
+    other.level = new Level(frozen);
+  }
+
+  level->release();
+  level = new Level(frozen->acquire());
+  size = other.size;
+  standaloneData = other.standaloneData;
+  standaloneOffsets = other.standaloneOffsets;
+}
+
+const void *ValueSet::sharedValues() const
+{
+  return level->parent;
+}
+
+const ValueSet::Level *ValueSet::find(unsigned int id,
+  unsigned int &index) const
+{
+  const Level *cells = level;
+  while (cells->parent != NULL)
+  {
+    index = cells->findEntry(id);
+    if (index != noEntry)
+    {
+      return cells;
+    }
+    cells = cells->parent;
+  }
+
+  index = id;
+  return cells;
+}
+
+unsigned int ValueSet::getMask(const Level *cells, unsigned int index)
+{
+  if (cells->parent != NULL)
+  {
+    return cells->entryMasks[index];
+  }
+
+  return cells->layerMasks[index];
+}
+
+const Argument &ValueSet::getCell(const Level *cells, unsigned int index,
+  Layer layer)
+{
+  if (cells->parent != NULL)
+  {
+    return cells->entryCells[index * layerCount + layer - 1];
+  }
+
+  return cells->layers[layer - 1][index];
+}
+
+ValueSet::Layer ValueSet::topLayer(unsigned int mask)
+{
+  return Layer(sizeof(unsigned int) * 8 - 1 - __builtin_clz(mask));
+}
+
+ValueSet::ArgumentVector &ValueSet::runtimeValues()
+{
+  return level->layers[layerCount - 1];
+}
+
+unsigned int ValueSet::addEntry(unsigned int id, unsigned int mask)
+{
+  // at most half of the slots are used
+  if ((level->entryIds.size() + 1) * 2 > level->slots.size())
+  {
+    level->slots.assign(
+      level->slots.empty() ? 16 : level->slots.size() * 2, 0);
+    for (unsigned int entry = 0; entry < level->entryIds.size(); ++entry)
+    {
+      level->addSlot(entry);
+    }
+  }
+
+  unsigned int entry = level->entryIds.size();
+  level->entryIds.push_back(id);
+  level->entryMasks.push_back(mask);
+  level->addSlot(entry);
+
+  return entry;
+}
+
+unsigned int ValueSet::writableEntry(unsigned int id)
+{
+  unsigned int entry = level->findEntry(id);
+  if (entry != noEntry)
+  {
+    return entry;
+  }
+
+  unsigned int index;
+  const Level *cells = find(id, index);
+  entry = addEntry(id, getMask(cells, index));
+
+  Argument::ValueType type = getCell(cells, index,
+    ArgumentParser::runtimeLayer).getType();
+  for (unsigned int i = 0; i < layerCount; ++i)
+  {
+    if (cells->parent == NULL && cells->layers[i].empty())
+    {
+      level->entryCells.push_back(Argument(type));
+    } else
+    {
+      level->entryCells.push_back(getCell(cells, index, Layer(i + 1)));
+    }
+  }
+
+  return entry;
+}
+
+Argument &ValueSet::at(unsigned int id, Layer layer)
+{
+  if (level->parent != NULL)
+  {
+    return level->entryCells[writableEntry(id) * layerCount + layer - 1];
+  }
+
+  ArgumentVector &values = level->layers[layer - 1];
+  if (values.empty())
+  {
+    const ArgumentVector &runtime = runtimeValues();
+    values.reserve(runtime.size());
+    for (ArgumentVector::const_iterator it = runtime.begin();
+      it != runtime.end(); ++it)
+    {
+      values.push_back(Argument(it->getType()));
+    }
+  }
+
+  return values[id];
+}
+
+void ValueSet::updateMask(unsigned int id, Layer layer)
+{
+  bool wasSet = at(id, layer).wasSet();
+  unsigned char &mask = level->parent != NULL ?
+    level->entryMasks[writableEntry(id)] : level->layerMasks[id];
+
+  if (wasSet)
+  {
+    mask |= 1 << layer;
+  } else
+  {
+    mask &= ~(1 << layer);
+  }
+}
+
+const Argument &ValueSet::operator[](unsigned int id) const
+{
+  unsigned int index;
+  const Level *cells = find(id, index);
+  unsigned int mask = getMask(cells, index);
+  if (mask == 0)
+  {
+    return getCell(cells, index, ArgumentParser::runtimeLayer);
+  }
+
+  return getCell(cells, index, topLayer(mask));
+}
+
+bool ValueSet::isSet(unsigned int id) const
+{
+  unsigned int index;
+  const Level *cells = find(id, index);
+  return getMask(cells, index) != 0;
+}
+
+ValueSet::Layer ValueSet::getLayer(unsigned int id) const
+{
+  unsigned int index;
+  const Level *cells = find(id, index);
+  unsigned int mask = getMask(cells, index);
+  if (mask == 0)
+  {
+    return ArgumentParser::defaultLayer;
+  }
+
+  return topLayer(mask);
+}
+
+void ValueSet::set(unsigned int id, Layer layer, bool value)
+{
+  at(id, layer).set(value);
+  updateMask(id, layer);
+}
+
+void ValueSet::set(unsigned int id, Layer layer, int value)
+{
+  at(id, layer).set(value);
+  updateMask(id, layer);
+}
+
+void ValueSet::set(unsigned int id, Layer layer, unsigned int value)
+{
+  at(id, layer).set(value);
+  updateMask(id, layer);
+}
+
+void ValueSet::set(unsigned int id, Layer layer, double value)
+{
+  at(id, layer).set(value);
+  updateMask(id, layer);
+}
+
+void ValueSet::set(unsigned int id, Layer layer, const char *value)
+{
+  Argument &argument = at(id, layer);
+
+  if (value != NULL && argument.hasType(Argument::stringType))
+  {
+    // the old value may be copied from a parent, which keeps it
+    argument.borrow(level->strings.replace(argument.getString(), value));
+  } else
+  {
+    level->strings.release(argument.getString());
+    argument.set(value);
+  }
+  updateMask(id, layer);
+}
+
+void ValueSet::clearLayer(Layer layer, Bitset &changed)
+{
+  changed.clear();
+
+  unsigned int bit = 1 << layer;
+  for (unsigned int id = 0; id < size; ++id)
+  {
+    unsigned int index;
+    const Level *cells = find(id, index);
+    unsigned int mask = getMask(cells, index);
+    if ((mask & bit) == 0)
+    {
+      continue;
+    }
+
+    // the value only changes if no upper layer overrides it
+    if (mask < (bit << 1))
+    {
+      changed.set(id);
+    }
+
+    Argument *cell;
+    if (level->parent != NULL)
+    {
+      unsigned int entry = writableEntry(id);
+      cell = &level->entryCells[entry * layerCount + layer - 1];
+      level->entryMasks[entry] = mask & ~bit;
+    } else
+    {
+      cell = &level->layers[layer - 1][id];
+      level->layerMasks[id] = mask & ~bit;
+    }
+    level->strings.release(cell->getString());
+    cell->clear();
+  }
+}
+
+void ValueSet::addMemoryUsage(MemoryUsage &usage) const
+{
+  for (const Level *cells = level; cells != NULL; cells = cells->parent)
+  {
+    usage.values += sizeof(Level) + cells->layerMasks.capacity()
+      + cells->entryIds.capacity() * sizeof(unsigned int)
+      + cells->entryMasks.capacity()
+      + cells->entryCells.capacity() * sizeof(Argument)
+      + cells->slots.capacity() * sizeof(unsigned int);
+    for (unsigned int i = 0; i < layerCount; ++i)
+    {
+      usage.values += cells->layers[i].capacity() * sizeof(Argument);
+    }
+    usage.buffers += cells->strings.capacity();
+  }
+  usage.buffers += standaloneData.capacity()
+    + standaloneOffsets.capacity() * sizeof(size_t);
+}
+
+const char *ValueSet::store(const char *str)
+{
+  return level->strings.store(str);
+}
+
+void ValueSet::addStandalone(const char *standalone)
+{
+  size_t length = strlen(standalone) + 1;
+  standaloneOffsets.push_back(standaloneData.size());
+  standaloneData.insert(standaloneData.end(), standalone, standalone + length);
+}
+
+size_t ValueSet::getStandaloneCount() const
+{
+  return standaloneOffsets.size();
+}
+
+const char *ValueSet::getStandalone(size_t index) const
+{
+  return &standaloneData[standaloneOffsets[index]];
+}
+
+void ValueSet::reserveStandalones(size_t count, size_t bytes)
+{
+  standaloneOffsets.reserve(count);
+  standaloneData.reserve(bytes);
+}
+
+size_t ValueSet::getStandaloneData(const char **data,
+  const size_t **offsets) const
+{
+  if (standaloneOffsets.empty())
+  {
+    *data = NULL;
+    *offsets = NULL;
+    return 0;
+  }
+
+  *data = &standaloneData[0];
+  *offsets = &standaloneOffsets[0];
+  return standaloneOffsets.size();
+}
@@ -0,0 +1,139 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: elor
+ */
+
+#include <WorkerPool.hpp>
+
+using namespace std;
+
+// the pool and queue of the current worker thread
+static thread_local WorkerPool *currentPool = NULL;
+static thread_local unsigned int currentQueue = 0;
+
+WorkerPool::WorkerPool(unsigned int threadCount) :
+  queued(0), nextQueue(0), stopping(false)
+{
+  if (threadCount == 0)
+  {
+    threadCount = 1;
+  }
+
+  for (unsigned int i = 0; i < threadCount; ++i)
+  {
+    queues.push_back(new Queue);
+  }
+
+  for (unsigned int i = 0; i < threadCount; ++i)
+  {
+    threads.push_back(thread(&WorkerPool::run, this, i));
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    lock_guard<mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeup.notify_all();
+
+  for (vector<thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    it->join();
+  }
+
+  for (vector<Queue*>::iterator it = queues.begin(); it != queues.end(); ++it)
+  {
+    delete *it;
+  }
+}
+
+unsigned int WorkerPool::size() const
+{
+  return threads.size();
+}
+
+void WorkerPool::submit(Function function, void *argument)
+{
+  unsigned int index;
+  if (currentPool == this)
+  {
+    index = currentQueue;
+  } else
+  {
+    index = nextQueue.fetch_add(1, memory_order_relaxed) % queues.size();
+  }
+
+  Job job = { function, argument };
+  {
+    lock_guard<mutex> lock(queues[index]->mutex);
+    queues[index]->jobs.push_back(job);
+  }
+  queued.fetch_add(1, memory_order_release);
+
+  // a worker that is about to sleep holds the lock while checking queued
+  {
+    lock_guard<mutex> lock(sleepMutex);
+  }
+  wakeup.notify_one();
+}
+
+bool WorkerPool::pop(unsigned int index, Job &job)
+{
+  // own queue first, newest job
+  {
+    Queue &own = *queues[index];
+    lock_guard<mutex> lock(own.mutex);
+    if (!own.jobs.empty())
+    {
+      job = own.jobs.back();
+      own.jobs.pop_back();
+      return true;
+    }
+  }
+
+  // steal the oldest job of another queue
+  for (unsigned int i = 1; i < queues.size(); ++i)
+  {
+    Queue &other = *queues[(index + i) % queues.size()];
+    lock_guard<mutex> lock(other.mutex);
+    if (!other.jobs.empty())
+    {
+      job = other.jobs.front();
+      other.jobs.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void WorkerPool::run(unsigned int index)
+{
+  currentPool = this;
+  currentQueue = index;
+
+  while (true)
+  {
+    Job job;
+    if (pop(index, job))
+    {
+      queued.fetch_sub(1, memory_order_relaxed);
+      job.function(job.argument);
+      continue;
+    }
+
+    unique_lock<mutex> lock(sleepMutex);
+    if (queued.load(memory_order_acquire) == 0)
+    {
+      if (stopping)
+      {
+        return;
+      }
+      wakeup.wait(lock);
+    }
+  }
+}
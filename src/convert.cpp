@@ -3,40 +3,29 @@
 #include <cctype>
 #include <cerrno>
 #include <cstring>
+#include <strings.h>
 
 int convert(const char *str, bool *out)
 {
-  char *lowerStr = strdup(str);
-  char *p = lowerStr;
-  while (*p != '\0')
-  {
-    *p = tolower(*p);
-    ++p;
-  }
-
-  char *begin = lowerStr;
-  while (!isgraph(*begin))
+  // compare the first word case-insensitively, without copying the string
+  const char *begin = str;
+  while (*begin != '\0' && !isgraph(*begin))
   {
     ++begin;
   }
 
-  if (*begin == '\0')
-  {
-    return 1;
-  }
-
-  char *end = begin;
+  const char *end = begin;
   while (isgraph(*end))
   {
     ++end;
   }
-  *end = '\0';
 
-  if (strcmp(begin, "false") == 0)
+  size_t length = end - begin;
+  if (length == 5 && strncasecmp(begin, "false", length) == 0)
   {
     *out = false;
   }
-  else if (strcmp(begin, "true") == 0)
+  else if (length == 4 && strncasecmp(begin, "true", length) == 0)
   {
     *out = true;
   }
@@ -45,8 +34,6 @@ int convert(const char *str, bool *out)
     return 1;
   }
 
-  free(lowerStr);
-
   return 0;
 }
 
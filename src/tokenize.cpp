@@ -0,0 +1,217 @@
+#include <tokenize.hpp>
+#include <cctype>
+#include <cstddef>
+
+char *nextToken(char **cursor, char *end)
+{
+  char *read = *cursor;
+  while (read < end && isspace((unsigned char) *read))
+  {
+    ++read;
+  }
+
+  if (read >= end)
+  {
+    *cursor = end;
+    return NULL;
+  }
+
+  char *token = read;
+  char *write = read;
+  char quote = '\0';
+
+  while (read < end)
+  {
+    char c = *read;
+
+    if (quote == '\'')
+    {
+      if (c == '\'')
+      {
+        quote = '\0';
+      } else
+      {
+        *write++ = c;
+      }
+    } else if (quote == '"')
+    {
+      if (c == '"')
+      {
+        quote = '\0';
+      } else if (c == '\\' && read + 1 < end
+        && (read[1] == '"' || read[1] == '\\'))
+      {
+        *write++ = *++read;
+      } else
+      {
+        *write++ = c;
+      }
+    } else if (isspace((unsigned char) c))
+    {
+      break;
+    } else if (c == '\'' || c == '"')
+    {
+      quote = c;
+    } else if (c == '\\' && read + 1 < end)
+    {
+      *write++ = *++read;
+    } else
+    {
+      *write++ = c;
+    }
+
+    ++read;
+  }
+
+  // skip the delimiter before it gets overwritten
+  *cursor = (read < end) ? read + 1 : end;
+  *write = '\0';
+
+  return token;
+}
+
+// end of a dotted key: alphanumeric parts separated by dots
+static const char *findKeyEnd(const char *keyStart)
+{
+  const char *keyStop = keyStart;
+  while (isalnum(*keyStop) || (*keyStop == '.' && isalnum(keyStop[1])))
+  {
+    ++keyStop;
+  }
+
+  return keyStop;
+}
+
+static LineType splitSection(const char *line, const char **section,
+  const char **sectionEnd)
+{
+  const char *sectionStart = line + 1;
+  while (isblank(*sectionStart))
+  {
+    ++sectionStart;
+  }
+
+  const char *sectionStop = findKeyEnd(sectionStart);
+  const char *ptr = sectionStop;
+  while (isblank(*ptr))
+  {
+    ++ptr;
+  }
+  if (sectionStop == sectionStart || *ptr != ']')
+  {
+    return syntaxErrorLine;
+  }
+
+  // nothing but blanks may follow
+  ++ptr;
+  while (isblank(*ptr))
+  {
+    ++ptr;
+  }
+  if (*ptr != '\0')
+  {
+    return syntaxErrorLine;
+  }
+
+  *section = sectionStart;
+  *sectionEnd = sectionStop;
+
+  return sectionLine;
+}
+
+LineType splitLine(const char *line, const char **key, const char **keyEnd,
+  const char **value, const char **valueEnd)
+{
+  // line format (regex): /^\s*\([a-zA-Z0-9.]*\)\s*=\s*\(\S*\)\s*$/
+  // or /^\s*\[\s*\([a-zA-Z0-9.]*\)\s*\]\s*$/
+
+  const char *keyStart = line;
+  // strip leading blanks
+  while (isblank(*keyStart))
+  {
+    ++keyStart;
+  }
+
+  if (*keyStart == '[')
+  {
+    return splitSection(keyStart, key, keyEnd);
+  }
+
+  // abort on \0 or !alnum
+  if (!isalnum(*keyStart))
+  {
+    switch (keyStart[0])
+    {
+    case '\0':
+    case '%':
+    case '#':
+    case '"':
+    case '/':
+    case '!':
+      return ignoredLine;
+    default:
+      return unexpectedCharacterLine;
+    }
+  }
+
+  // find end of key
+  const char *keyStop = findKeyEnd(keyStart);
+
+  // strip blanks in front of '='
+  const char *ptr = keyStop;
+  while (isblank(*ptr))
+  {
+    ++ptr;
+  }
+
+  // validate existing '='
+  if (*ptr != '=')
+  {
+    return ignoredLine;
+  }
+
+  const char *valueStart = ptr + 1;
+  // strip blanks in front of value
+  while (isblank(*valueStart))
+  {
+    ++valueStart;
+  }
+
+  // validate valid value
+  if (!isprint(*valueStart))
+  {
+    return ignoredLine;
+  }
+
+  // search for unexpected symbols in value
+  const char *valueStop = valueStart;
+  while (isprint(*valueStop))
+  {
+    ++valueStop;
+  }
+  // if everything's correct, we're at the end of the string
+  if (*valueStop != '\0')
+  {
+    return ignoredLine;
+  }
+
+  // strip trailing blanks
+  --valueStop;
+  while (isblank(*valueStop))
+  {
+    --valueStop;
+  }
+
+  ++valueStop;
+  if (valueStop <= valueStart)
+  {
+    return syntaxErrorLine;
+  }
+
+  *key = keyStart;
+  *keyEnd = keyStop;
+  *value = valueStart;
+  *valueEnd = valueStop;
+
+  return assignmentLine;
+}